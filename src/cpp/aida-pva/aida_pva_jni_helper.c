@@ -8,6 +8,7 @@
  *     **ATTRIBUTES**=JNI
  *
  */
+#include <limits.h>
 #include "aida_pva_server_helper.h"
 #include "aida_pva_jni_helper.h"
 
@@ -15,6 +16,17 @@ static int getArgumentClasses(JNIEnv* env, ArgumentClasses* argumentClasses);
 static void getArgumentClassMethods(JNIEnv* env, ArgumentMethods* argumentMethods);
 static int checkMethods(JNIEnv* env, ArgumentMethods* argumentMethods);
 static int allocateSpaceForArguments(JNIEnv* env, Arguments* cArgs, int totalFloatingPoints);
+static jobjectArray toStringColumn(JNIEnv* env, char** strings, int rowCount);
+static int* stringColumnFirstRows(char** strings, int rowCount);
+static int toColumnData(JNIEnv* env, jobject tableToReturn, jmethodID mColumnBuffer, jmethodID mSetColumnData,
+        Table table);
+
+/**
+ * Cache of java Strings for recurring names, organised as JSTRING_CACHE_SETS sets of JSTRING_CACHE_WAYS entries.
+ * No locking is needed because requests to the native provider are serialised by the java service
+ */
+static InternedString internedStrings[JSTRING_CACHE_SETS * JSTRING_CACHE_WAYS];
+static unsigned long internedStringsClock = 0;
 
 /**
  * Create a new java object
@@ -77,15 +89,60 @@ char* toCString(JNIEnv* env, jstring string) {
 /**
  * Convert C string to jstring.
  *
+ * Short strings, such as device names and field labels, are interned in
+ * a bounded least recently used cache of java Strings so that names that recur
+ * across requests are only converted once.
+ *
  * @param env environment.
  * @param string C string.
- * @return jstring.
+ * @return jstring as a new local reference.
  */
 jstring toJString(JNIEnv* env, const char* string) {
     if (!string) {
         return NULL;
     }
-    return (*env)->NewStringUTF(env, string);
+
+    size_t length = strlen(string);
+    if (length > JSTRING_CACHE_MAX_LENGTH) {
+        return (*env)->NewStringUTF(env, string);
+    }
+
+    // Look for the string in its set, remembering the empty or least recently used entry in case it is not there
+    unsigned int hash = aidaHash(string);
+    InternedString* set = &internedStrings[(hash & (JSTRING_CACHE_SETS - 1)) * JSTRING_CACHE_WAYS];
+    InternedString* victim = set;
+    for (int way = 0; way < JSTRING_CACHE_WAYS; way++) {
+        InternedString* entry = &set[way];
+        if (!entry->globalString) {
+            if (victim->globalString) {
+                victim = entry;
+            }
+        } else if (entry->hash == hash && strcmp(entry->string, string) == 0) {
+            entry->lastUsed = ++internedStringsClock;
+            return (*env)->NewLocalRef(env, entry->globalString);
+        } else if (victim->globalString && entry->lastUsed < victim->lastUsed) {
+            victim = entry;
+        }
+    }
+
+    jstring localString = (*env)->NewStringUTF(env, string);
+    if (!localString) {
+        return NULL;
+    }
+
+    // Intern it in place of the victim.  If a global reference can't be made then just don't cache it
+    jstring globalString = (*env)->NewGlobalRef(env, localString);
+    if (globalString) {
+        if (victim->globalString) {
+            (*env)->DeleteGlobalRef(env, victim->globalString);
+        }
+        victim->globalString = globalString;
+        victim->hash = hash;
+        victim->lastUsed = ++internedStringsClock;
+        memcpy(victim->string, string, length + 1);
+    }
+
+    return localString;
 }
 
 /**
@@ -673,9 +730,15 @@ jobjectArray toStringArray(JNIEnv* env, StringArray array) {
         return NULL;
     }
 
-    // Copy values
+    // Copy values, deleting each local reference once it is held by the array so large arrays can't exhaust the local reference table
     for (int i = 0; i < array.count; i++) {
-        (*env)->SetObjectArrayElement(env, returnValue, i, toJString(env, array.items[i]));
+        jstring stringValue = toJString(env, array.items[i]);
+        if ((*env)->ExceptionCheck(env)) {
+            releaseStringArray(array);
+            return NULL;
+        }
+        (*env)->SetObjectArrayElement(env, returnValue, i, stringValue);
+        (*env)->DeleteLocalRef(env, stringValue);
     }
 
     // Free up array
@@ -689,11 +752,17 @@ jobjectArray toStringArray(JNIEnv* env, StringArray array) {
  * from the given {@link Table} structure.
  *
  * Tables are returned as lists of Lists so:-
- * we create a java ArrayList
- * then for each column in the table
+ * we create a java AidaTable
+ * then add any field and label overrides
+ * then we ask it for a direct ByteBuffer and write the whole table into it as a columnar payload
+ *   that the java side decodes straight into the returned structure.
+ * If it can't provide one, e.g. because the table is too large, then for each column in the table
  *   we create a sub list
- *   then we loop over each row to call add() to add entries to that list
+ *   then we loop over each row to call add() to add entries to that list,
+ *   or for string columns we convert the whole column to a String[] and call addAll()
  *   then we add() the sublist to the main list
+ * Each column is converted in its own local reference frame so that
+ * no local references are left over however large the table is
  *
  * @param env environment.
  * @param table the {@link Table} provided
@@ -716,6 +785,30 @@ jobject toTable(JNIEnv* env, Table table) {
         return NULL;
     }
 
+    // retrieve the addAll method of the list
+    jmethodID mAddAll = (*env)->GetMethodID(env, cList, "addAll", "(I[Ljava/lang/Object;)Z");
+    if (!mAddAll) {
+        aidaThrowNonOsException(env, UNABLE_TO_GET_DATA_EXCEPTION,
+                "Failed to find the addAll(int, Object[]) method on AidaTable object");
+        return NULL;
+    }
+
+    // retrieve the columnBuffer method of the list
+    jmethodID mColumnBuffer = (*env)->GetMethodID(env, cList, "columnBuffer", "(I)Ljava/nio/ByteBuffer;");
+    if (!mColumnBuffer) {
+        aidaThrowNonOsException(env, UNABLE_TO_GET_DATA_EXCEPTION,
+                "Failed to find the columnBuffer(int) method on AidaTable object");
+        return NULL;
+    }
+
+    // retrieve the setColumnData method of the list
+    jmethodID mSetColumnData = (*env)->GetMethodID(env, cList, "setColumnData", "(Ljava/nio/ByteBuffer;)V");
+    if (!mSetColumnData) {
+        aidaThrowNonOsException(env, UNABLE_TO_GET_DATA_EXCEPTION,
+                "Failed to find the setColumnData(ByteBuffer) method on AidaTable object");
+        return NULL;
+    }
+
     // retrieve the add method of the list
     jmethodID mAddField = (*env)->GetMethodID(env, cList, "addField", "(Ljava/lang/String;)Z");
     if (!mAddField) {
@@ -737,7 +830,7 @@ jobject toTable(JNIEnv* env, Table table) {
         return NULL;
     }
 
-    // Loop over each column
+    // Loop over each column adding field and label overrides
     for (int column = 0; column < table._currentColumn; column++) {
         // If field overrides are defined then add them
         if (table.ppFields) {
@@ -772,6 +865,31 @@ jobject toTable(JNIEnv* env, Table table) {
             free(labelName);
             table.ppLabels[column] = NULL;
         }
+    }
+
+    // Write the whole table into a direct buffer if the java side can provide one
+    if (toColumnData(env, tableToReturn, mColumnBuffer, mSetColumnData, table) == EXIT_SUCCESS) {
+        releaseTable(table);
+        return tableToReturn;
+    }
+    ON_EXCEPTION_RETURN_(NULL)
+
+    // Otherwise loop over each column adding the values one by one
+    for (int column = 0; column < table._currentColumn; column++) {
+        if ((*env)->PushLocalFrame(env, TABLE_COLUMN_LOCAL_FRAME_SIZE)) {
+            return NULL;
+        }
+
+        // String columns are held contiguously so are converted to a String[] and added in one go
+        if (table.types[column] == AIDA_STRING_ARRAY_TYPE) {
+            jobjectArray stringColumn = toStringColumn(env, (char**)table.ppData[column], table.rowCount);
+            ON_EXCEPTION_POP_LOCAL_FRAME_AND_RETURN_(NULL)
+
+            (*env)->CallBooleanMethod(env, tableToReturn, mAddAll, column, stringColumn);
+            (*env)->DeleteLocalRef(env, stringColumn);
+            (*env)->PopLocalFrame(env, NULL);
+            continue;
+        }
 
         // loop over each row
         for (int row = 0; row < table.rowCount; row++) {
@@ -779,7 +897,7 @@ jobject toTable(JNIEnv* env, Table table) {
             case AIDA_BOOLEAN_ARRAY_TYPE : {
                 jboolean data = ((jboolean*)(table.ppData[column]))[row];
                 jobject dataObject = toBoolean(env, data);
-                ON_EXCEPTION_RETURN_(NULL)
+                ON_EXCEPTION_POP_LOCAL_FRAME_AND_RETURN_(NULL)
 
                 (*env)->CallBooleanMethod(env, tableToReturn, mAdd, column, dataObject);
                 (*env)->DeleteLocalRef(env, dataObject);
@@ -788,7 +906,7 @@ jobject toTable(JNIEnv* env, Table table) {
             case AIDA_BYTE_ARRAY_TYPE: {
                 jbyte data = ((jbyte*)(table.ppData[column]))[row];
                 jobject dataObject = toByte(env, data);
-                ON_EXCEPTION_RETURN_(NULL)
+                ON_EXCEPTION_POP_LOCAL_FRAME_AND_RETURN_(NULL)
 
                 (*env)->CallBooleanMethod(env, tableToReturn, mAdd, column, dataObject);
                 (*env)->DeleteLocalRef(env, dataObject);
@@ -797,7 +915,7 @@ jobject toTable(JNIEnv* env, Table table) {
             case AIDA_SHORT_ARRAY_TYPE: {
                 jshort data = (jshort)((short*)(table.ppData[column]))[row];
                 jobject dataObject = toShort(env, data);
-                ON_EXCEPTION_RETURN_(NULL)
+                ON_EXCEPTION_POP_LOCAL_FRAME_AND_RETURN_(NULL)
 
                 (*env)->CallBooleanMethod(env, tableToReturn, mAdd, column, dataObject);
                 (*env)->DeleteLocalRef(env, dataObject);
@@ -806,7 +924,7 @@ jobject toTable(JNIEnv* env, Table table) {
             case AIDA_INTEGER_ARRAY_TYPE: {
                 jint data = (jint)((int*)(table.ppData[column]))[row];
                 jobject dataObject = toInteger(env, data);
-                ON_EXCEPTION_RETURN_(NULL)
+                ON_EXCEPTION_POP_LOCAL_FRAME_AND_RETURN_(NULL)
 
                 (*env)->CallBooleanMethod(env, tableToReturn, mAdd, column, dataObject);
                 (*env)->DeleteLocalRef(env, dataObject);
@@ -815,7 +933,7 @@ jobject toTable(JNIEnv* env, Table table) {
             case AIDA_LONG_ARRAY_TYPE: {
                 jlong data = (jlong)((long*)(table.ppData[column]))[row];
                 jobject dataObject = toLong(env, data);
-                ON_EXCEPTION_RETURN_(NULL)
+                ON_EXCEPTION_POP_LOCAL_FRAME_AND_RETURN_(NULL)
 
                 (*env)->CallBooleanMethod(env, tableToReturn, mAdd, column, dataObject);
                 (*env)->DeleteLocalRef(env, dataObject);
@@ -824,7 +942,7 @@ jobject toTable(JNIEnv* env, Table table) {
             case AIDA_FLOAT_ARRAY_TYPE: {
                 jfloat data = ((jfloat*)(table.ppData[column]))[row];
                 jobject dataObject = toFloat(env, data);
-                ON_EXCEPTION_RETURN_(NULL)
+                ON_EXCEPTION_POP_LOCAL_FRAME_AND_RETURN_(NULL)
 
                 (*env)->CallBooleanMethod(env, tableToReturn, mAdd, column, dataObject);
                 (*env)->DeleteLocalRef(env, dataObject);
@@ -833,30 +951,21 @@ jobject toTable(JNIEnv* env, Table table) {
             case AIDA_DOUBLE_ARRAY_TYPE: {
                 jdouble data = ((jdouble*)(table.ppData[column]))[row];
                 jobject dataObject = toDouble(env, data);
-                ON_EXCEPTION_RETURN_(NULL)
+                ON_EXCEPTION_POP_LOCAL_FRAME_AND_RETURN_(NULL)
 
                 (*env)->CallBooleanMethod(env, tableToReturn, mAdd, column, dataObject);
                 (*env)->DeleteLocalRef(env, dataObject);
                 break;
             }
-            case AIDA_STRING_ARRAY_TYPE: {
-                char* string = ((char**)(table.ppData[column]))[row];
-                jstring stringValue = toJString(env, string);
-                ON_EXCEPTION_FREE_STRING_AND_RETURN_(NULL)
-
-                (*env)->CallBooleanMethod(env, tableToReturn, mAdd, column, stringValue);
-
-                // Free up string buffer
-                (*env)->DeleteLocalRef(env, stringValue);
-                free(string);
-                break;
-            }
             default:
                 aidaThrowNonOsException(env, UNABLE_TO_GET_DATA_EXCEPTION,
                         "Unsupported type found in table.  Perhaps you declared a table with n columns but didnt add n columns");
+                (*env)->PopLocalFrame(env, NULL);
                 return NULL;
             }
         }
+
+        (*env)->PopLocalFrame(env, NULL);
     }
 
     releaseTable(table);
@@ -864,6 +973,293 @@ jobject toTable(JNIEnv* env, Table table) {
     return tableToReturn;
 }
 
+/**
+ * Create a new java String[] from a contiguous string column of a {@link Table}.
+ * The strings are not freed as they belong to the column's single buffer which
+ * is released along with the rest of the table.
+ *
+ * Rows with the same string share the same pointer in the column, so each distinct pointer
+ * is only converted to a java String once, and that String is reused for the other rows.
+ *
+ * @param env environment.
+ * @param strings the row pointers of the string column
+ * @param rowCount the number of rows in the column
+ * @return new java String[]
+ */
+static jobjectArray toStringColumn(JNIEnv* env, char** strings, int rowCount) {
+    // Get a class reference for java.lang.String
+    jclass classString = (*env)->FindClass(env, "java/lang/String");
+    if (!classString) {
+        aidaThrowNonOsException(env, UNABLE_TO_GET_DATA_EXCEPTION, "Failed to get jclass of java String");
+        return NULL;
+    }
+
+    jobjectArray stringColumn = (*env)->NewObjectArray(env, rowCount, classString, NULL);
+    if (!stringColumn) {
+        char errorString[BUFSIZ];
+        sprintf(errorString, "Failed to create a new String Array with %d elements", rowCount);
+        aidaThrowNonOsException(env, UNABLE_TO_GET_DATA_EXCEPTION, errorString);
+        return NULL;
+    }
+
+    // If this can't be allocated then every row is simply converted
+    int* firstRows = stringColumnFirstRows(strings, rowCount);
+
+    // Copy values
+    for (int row = 0; row < rowCount; row++) {
+        jstring stringValue;
+
+        if (firstRows && firstRows[row] != row) {
+            // Seen before
+            stringValue = (*env)->GetObjectArrayElement(env, stringColumn, firstRows[row]);
+        } else {
+            stringValue = toJString(env, strings[row]);
+            if ((*env)->ExceptionCheck(env)) {
+                free(firstRows);
+                return NULL;
+            }
+        }
+
+        (*env)->SetObjectArrayElement(env, stringColumn, row, stringValue);
+        (*env)->DeleteLocalRef(env, stringValue);
+    }
+
+    free(firstRows);
+    return stringColumn;
+}
+
+/**
+ * For each row of a string column of a {@link Table}, find the first row with the same string.
+ * Rows with the same string share the same pointer in the column, so the distinct strings
+ * are found by comparing pointers rather than the strings themselves.
+ *
+ * @param strings the row pointers of the string column
+ * @param rowCount the number of rows in the column
+ * @return allocated array of the first row for each row, that the caller must free,
+ * or NULL if it could not be allocated
+ */
+static int* stringColumnFirstRows(char** strings, int rowCount) {
+    int* firstRows = malloc((rowCount ? rowCount : 1) * sizeof(int));
+    if (!firstRows) {
+        return NULL;
+    }
+
+    // Map of each distinct string pointer to the first row it appears in, open addressed, at most half full
+    unsigned int mapSize = 16;
+    while (mapSize < (unsigned int)rowCount * 2) {
+        mapSize *= 2;
+    }
+    char** mapStrings = calloc(mapSize, sizeof(char*) + sizeof(int));
+    if (!mapStrings) {
+        free(firstRows);
+        return NULL;
+    }
+    int* mapRows = (int*)(mapStrings + mapSize);
+    int firstNullRow = -1;
+
+    for (int row = 0; row < rowCount; row++) {
+        char* string = strings[row];
+
+        if (!string) {
+            if (firstNullRow < 0) {
+                firstNullRow = row;
+            }
+            firstRows[row] = firstNullRow;
+        } else if (row && string == strings[row - 1]) {
+            // Same as the previous row
+            firstRows[row] = firstRows[row - 1];
+        } else {
+            unsigned int slot = (unsigned int)(((size_t)string >> 3) * 2654435761u) & (mapSize - 1);
+            while (mapStrings[slot] && mapStrings[slot] != string) {
+                slot = (slot + 1) & (mapSize - 1);
+            }
+            if (!mapStrings[slot]) {
+                mapStrings[slot] = string;
+                mapRows[slot] = row;
+            }
+            firstRows[row] = mapRows[slot];
+        }
+    }
+
+    free(mapStrings);
+    return firstRows;
+}
+
+/**
+ * Write the given {@link Table} into a direct ByteBuffer obtained from the given java AidaTable,
+ * as the columnar payload that is decoded by AidaPVHelper.
+ *
+ * The payload is in native byte order:
+ * - jint column count, jint row count
+ * - then, for each column, starting on an 8 byte boundary
+ *   - jint type, from 0 for AIDA_BOOLEAN_ARRAY_TYPE to 7 for AIDA_STRING_ARRAY_TYPE
+ *   - jint number of distinct strings for string columns, otherwise 0
+ *   - the row count values, booleans and bytes as one byte each and longs as jlong, or for string columns
+ *     the distinct strings, each a jint length followed by its bytes, then, on a 4 byte boundary,
+ *     a jint index into the distinct strings for each row
+ *
+ * @param env environment.
+ * @param tableToReturn the java AidaTable
+ * @param mColumnBuffer the columnBuffer(int) method of the java AidaTable
+ * @param mSetColumnData the setColumnData(ByteBuffer) method of the java AidaTable, called to publish the
+ * buffer once the whole payload has been written
+ * @param table the {@link Table} provided
+ * @return EXIT_SUCCESS if the table was written, EXIT_FAILURE if no buffer could be
+ * obtained or an exception was raised
+ */
+static int toColumnData(JNIEnv* env, jobject tableToReturn, jmethodID mColumnBuffer, jmethodID mSetColumnData,
+        Table table) {
+    int columnCount = table._currentColumn;
+    int rowCount = table.rowCount;
+    int status = EXIT_SUCCESS;
+
+    // The first row of each row's string, for the string columns
+    int** firstRows = calloc(columnCount ? columnCount : 1, sizeof(int*));
+    if (!firstRows) {
+        return EXIT_FAILURE;
+    }
+
+    // Work out the size of the payload
+    size_t size = 2 * sizeof(jint);
+    for (int column = 0; column < columnCount && status == EXIT_SUCCESS; column++) {
+        size = COLUMN_DATA_ALIGN(size, 8) + 2 * sizeof(jint);
+        switch (table.types[column]) {
+        case AIDA_BOOLEAN_ARRAY_TYPE:
+        case AIDA_BYTE_ARRAY_TYPE:
+            size += rowCount * sizeof(jbyte);
+            break;
+        case AIDA_SHORT_ARRAY_TYPE:
+            size += rowCount * sizeof(jshort);
+            break;
+        case AIDA_INTEGER_ARRAY_TYPE:
+        case AIDA_FLOAT_ARRAY_TYPE:
+            size += rowCount * sizeof(jint);
+            break;
+        case AIDA_LONG_ARRAY_TYPE:
+        case AIDA_DOUBLE_ARRAY_TYPE:
+            size += rowCount * sizeof(jlong);
+            break;
+        case AIDA_STRING_ARRAY_TYPE: {
+            char** strings = (char**)table.ppData[column];
+            if (!(firstRows[column] = stringColumnFirstRows(strings, rowCount))) {
+                status = EXIT_FAILURE;
+                break;
+            }
+            for (int row = 0; row < rowCount; row++) {
+                if (firstRows[column][row] == row) {
+                    size += sizeof(jint) + strlen(strings[row] ? strings[row] : NULL_TABLE_STRING);
+                }
+            }
+            size = COLUMN_DATA_ALIGN(size, 4) + rowCount * sizeof(jint);
+            break;
+        }
+        default:
+            // Leave unsupported types to be reported when the columns are added one by one
+            status = EXIT_FAILURE;
+            break;
+        }
+    }
+
+    // Get a buffer big enough for the payload
+    unsigned char* data = NULL;
+    jobject buffer = NULL;
+    if (status == EXIT_SUCCESS && size <= INT_MAX) {
+        buffer = (*env)->CallObjectMethod(env, tableToReturn, mColumnBuffer, (jint)size);
+        if (buffer && !(*env)->ExceptionCheck(env)) {
+            data = (unsigned char*)(*env)->GetDirectBufferAddress(env, buffer);
+        }
+    }
+
+    if (data) {
+        size_t offset = 0;
+        jint header[2];
+
+        header[0] = columnCount;
+        header[1] = rowCount;
+        memcpy(data, header, sizeof(header));
+        offset += sizeof(header);
+
+        for (int column = 0; column < columnCount; column++) {
+            void* columnData = table.ppData[column];
+            size_t headerOffset = offset = COLUMN_DATA_ALIGN(offset, 8);
+
+            header[0] = (jint)(table.types[column] - AIDA_BOOLEAN_ARRAY_TYPE);
+            header[1] = 0;
+            offset += sizeof(header);
+
+            switch (table.types[column]) {
+            case AIDA_BOOLEAN_ARRAY_TYPE:
+            case AIDA_BYTE_ARRAY_TYPE:
+                memcpy(data + offset, columnData, rowCount * sizeof(jbyte));
+                offset += rowCount * sizeof(jbyte);
+                break;
+            case AIDA_SHORT_ARRAY_TYPE:
+                memcpy(data + offset, columnData, rowCount * sizeof(jshort));
+                offset += rowCount * sizeof(jshort);
+                break;
+            case AIDA_INTEGER_ARRAY_TYPE:
+            case AIDA_FLOAT_ARRAY_TYPE:
+                memcpy(data + offset, columnData, rowCount * sizeof(jint));
+                offset += rowCount * sizeof(jint);
+                break;
+            case AIDA_DOUBLE_ARRAY_TYPE:
+                memcpy(data + offset, columnData, rowCount * sizeof(jdouble));
+                offset += rowCount * sizeof(jdouble);
+                break;
+            case AIDA_LONG_ARRAY_TYPE:
+                // C longs are widened to java longs
+                for (int row = 0; row < rowCount; row++) {
+                    jlong value = (jlong)((long*)columnData)[row];
+                    memcpy(data + offset, &value, sizeof(jlong));
+                    offset += sizeof(jlong);
+                }
+                break;
+            default: {
+                // Write each distinct string the first time it appears, and turn the first rows into indexes into them
+                char** strings = (char**)columnData;
+                int* indexes = firstRows[column];
+                for (int row = 0; row < rowCount; row++) {
+                    if (indexes[row] == row) {
+                        const char* string = strings[row] ? strings[row] : NULL_TABLE_STRING;
+                        jint length = (jint)strlen(string);
+                        memcpy(data + offset, &length, sizeof(jint));
+                        memcpy(data + offset + sizeof(jint), string, length);
+                        offset += sizeof(jint) + length;
+                        indexes[row] = header[1]++;
+                    } else {
+                        indexes[row] = indexes[indexes[row]];
+                    }
+                }
+                offset = COLUMN_DATA_ALIGN(offset, 4);
+                memcpy(data + offset, indexes, rowCount * sizeof(jint));
+                offset += rowCount * sizeof(jint);
+                break;
+            }
+            }
+
+            memcpy(data + headerOffset, header, sizeof(header));
+        }
+
+        // Only publish the buffer now that the whole payload is in it
+        (*env)->CallVoidMethod(env, tableToReturn, mSetColumnData, buffer);
+        if ((*env)->ExceptionCheck(env)) {
+            status = EXIT_FAILURE;
+        }
+    } else {
+        status = EXIT_FAILURE;
+    }
+
+    for (int column = 0; column < columnCount; column++) {
+        free(firstRows[column]);
+    }
+    free(firstRows);
+    if (buffer) {
+        (*env)->DeleteLocalRef(env, buffer);
+    }
+
+    return status;
+}
+
 /**
  * Free up any memory allocated for the given pv and arguments
  *
@@ -934,6 +1330,17 @@ void releaseTable(Table table) {
 	        table._currentColumn = 0;
         }
 
+        // Free string blocks of streaming tables
+        while (table._stringBlocks) {
+            TableStringBlock* next = table._stringBlocks->next;
+            free(table._stringBlocks);
+            table._stringBlocks = next;
+        }
+        if (table._stringDictionary.strings) {
+            free(table._stringDictionary.strings);
+            table._stringDictionary.strings = NULL;
+        }
+
         // Free field names
         if (table.ppFields) {
             for (int column = 0; column < table._currentField; column++) {
@@ -10,6 +10,49 @@ extern "C" {
 
 #include "aida_pva.h"
 
+/**
+ * The number of sets in the interned java String cache.  Must be a power of two
+ */
+#define JSTRING_CACHE_SETS 256
+
+/**
+ * The number of entries in each set of the interned java String cache.
+ * The least recently used entry in a set is replaced when a new string is interned
+ */
+#define JSTRING_CACHE_WAYS 4
+
+/**
+ * The longest C string that will be interned.  Longer strings are always converted afresh
+ */
+#define JSTRING_CACHE_MAX_LENGTH 63
+
+/**
+ * The initial size of the local reference frame used for each column when converting a table
+ */
+#define TABLE_COLUMN_LOCAL_FRAME_SIZE 16
+
+/**
+ * Round the given offset in a table's columnar payload up to the given alignment, a power of two
+ */
+#define COLUMN_DATA_ALIGN(_offset, _alignment) (((_offset) + (_alignment) - 1) & ~((size_t)(_alignment) - 1))
+
+/**
+ * The string written in a table's columnar payload in place of a NULL string, as java does for null column values
+ */
+#define NULL_TABLE_STRING "<null>"
+
+/**
+ * An entry in the interned java String cache.
+ * The java String is held as a global reference so that it can be reused across requests
+ */
+typedef struct
+{
+	unsigned int hash;
+	unsigned long lastUsed;
+	jstring globalString;
+	char string[JSTRING_CACHE_MAX_LENGTH + 1];
+} InternedString;
+
 /**
  * A structure to hold a java object and java class.
  */
@@ -84,9 +127,13 @@ char* toCString(JNIEnv* env, jstring string);
 /**
  * Convert C string to jstring.
  *
+ * Short strings, such as device names and field labels, are interned in
+ * a bounded least recently used cache of java Strings so that names that recur
+ * across requests are only converted once.
+ *
  * @param env environment.
  * @param string C string.
- * @return jstring.
+ * @return jstring as a new local reference.
  */
 jstring toJString(JNIEnv* env, const char* string);
 
@@ -26,6 +26,7 @@
 #include <stdarg.h>
 #include <ctype.h>
 #include <stdbool.h>
+#include <sys/time.h>            /* gettimeofday() */
 
 #include "slc_macros.h"           /* vmsstat_t, int2u, int4u, etc. */
 #include "sysutil_proto.h"        /* for cvt_vms_to_ieee_flt */
@@ -35,6 +36,11 @@
 #include "aida_pva_types_helper.h"
 
 static void allocateTableColumn(JNIEnv* env, Table* table, Type aidaType, size_t elementSize);
+static char** allocateStringTableColumn(JNIEnv* env, Table* table, void* data, size_t stringDataSize);
+static void tableEnsureRowCapacity(JNIEnv* env, Table* table, int rows);
+static char* tableCopyString(JNIEnv* env, Table* table, const char* string);
+static char** tableDictionarySlot(TableStringDictionary* dictionary, const char* string);
+static int tableDictionaryReserve(TableStringDictionary* dictionary, int count);
 static Type tableArrayTypeOf(Type type);
 static size_t tableElementSizeOfOf(Type type);
 static int vavscanf(JNIEnv* env, Arguments* arguments, Value* value, const char* formatString, va_list argp);
@@ -771,15 +777,16 @@ void tableAddColumn(JNIEnv* env, Table* table, Type type, void* data, bool ieeeF
 	// Correct type for tables
 	type = tableArrayTypeOf(type);
 
-	// Set column type, and allocate space
-	allocateTableColumn(env, table, type, tableElementSizeOfOf(type));
-	ON_EXCEPTION_RETURN_VOID
-
-	// Rest of processing for strings is done in addStringColumn
+	// Strings are stored in a single contiguous block so are handled by addStringColumn
 	if (type == AIDA_STRING_ARRAY_TYPE) {
+		tableAddStringColumn(env, table, (char**)data);
 		return;
 	}
 
+	// Set column type, and allocate space
+	allocateTableColumn(env, table, type, tableElementSizeOfOf(type));
+	ON_EXCEPTION_RETURN_VOID
+
 	if (!ieeeFormat) {
 		// Convert float values if float array
 		if (type == AIDA_FLOAT_ARRAY_TYPE) {
@@ -825,6 +832,43 @@ void tableAddColumn(JNIEnv* env, Table* table, Type type, void* data, bool ieeeF
 	table->_currentColumn++;
 }
 
+/**
+ * Add a column of arbitrary type to a Table, and return its data buffer, of `table->rowCount` elements,
+ * for the caller to fill in directly.  This saves copying data that has to be converted, or unpacked
+ * from a backend buffer, anyway.  The values must be in ieee format.
+ *
+ * @note
+ * Don't call this to add strings to the Table.  Use tableAddStringColumn() for that.
+ *
+ * @param env            The JNI environment.  Used in all functions involving JNI.
+ * @param table          the Table to add the column to.
+ * @param type           the type of this Table column.
+ * @return the column's data buffer, or NULL if an exception has been raised
+ */
+void* tableAddEmptyColumn(JNIEnv* env, Table* table, Type type)
+{
+	// Table full?
+	if (table->_currentColumn >= table->columnCount) {
+		aidaThrowNonOsException(env, UNABLE_TO_GET_DATA_EXCEPTION,
+				"Internal Error: more columns added than table size");
+		return NULL;
+	}
+
+	// Correct type for tables
+	type = tableArrayTypeOf(type);
+	if (type == AIDA_STRING_ARRAY_TYPE || !tableElementSizeOfOf(type)) {
+		aidaThrowNonOsException(env, UNABLE_TO_GET_DATA_EXCEPTION,
+				"Internal Error: Call to tableAddEmptyColumn() un-supported type");
+		return NULL;
+	}
+
+	// Set column type, and allocate space
+	allocateTableColumn(env, table, type, tableElementSizeOfOf(type));
+	ON_EXCEPTION_RETURN_(NULL)
+
+	return table->ppData[table->_currentColumn++];
+}
+
 void tableAddField(JNIEnv* env, Table* table, char* fieldName) {
 	// Table full?
 	if (table->_currentField >= table->columnCount) {
@@ -866,8 +910,9 @@ void tableAddLabel(JNIEnv* env, Table* table, char* labelName) {
 /**
  * Add a String column to the given Table.
  * This reads data from a buffer that is itself a list of pointers to strings.
- * We allocate just enough space to store the strings in our Table.  This is allocated
- * in one buffer so there is only one pointer to release.
+ * We allocate just enough space to store the distinct strings in our Table.  This is allocated
+ * in one buffer, the row pointers followed by the strings themselves, so there is only one pointer to release.
+ * Rows with the same string share one copy of it, so that it is only converted to a java String once.
  *
  * @note
  * The framework will release all memory associated with
@@ -911,14 +956,55 @@ void tableAddLabel(JNIEnv* env, Table* table, char* labelName) {
  */
 void tableAddStringColumn(JNIEnv* env, Table* table, char** data)
 {
-	tableAddColumn(env, table, AIDA_STRING_ARRAY_TYPE, data, false);
-	ON_EXCEPTION_RETURN_VOID
+	// Find the distinct strings, and total up the space needed to store them including their null terminators.
+	// The dictionary slot of each row, and whether the row is the first to hold its string, are kept for the copy
+	TableStringDictionary dictionary = { NULL, 0, 0 };
+	char*** rowSlots = NULL;
+	bool* firstRows = NULL;
+	size_t stringDataSize = 0;
+	if (data && table->rowCount > 0) {
+		rowSlots = malloc(table->rowCount * (sizeof(char**) + sizeof(bool)));
+		if (!rowSlots || tableDictionaryReserve(&dictionary, table->rowCount)) {
+			free(rowSlots);
+			aidaThrowNonOsException(env, AIDA_INTERNAL_EXCEPTION, "Could not allocate space for table string dictionary");
+			return;
+		}
+		firstRows = (bool*)(rowSlots + table->rowCount);
+		for (int row = 0; row < table->rowCount; row++) {
+			char* string = data[row] ? data[row] : "";
+			char** slot = tableDictionarySlot(&dictionary, string);
+			firstRows[row] = !*slot;
+			if (firstRows[row]) {
+				*slot = string;
+				dictionary.count++;
+				stringDataSize += strlen(string) + 1;
+			}
+			rowSlots[row] = slot;
+		}
+	}
+
+	char** stringArray = allocateStringTableColumn(env, table, data, stringDataSize);
+	if ((*env)->ExceptionCheck(env)) {
+		free(dictionary.strings);
+		free(rowSlots);
+		return;
+	}
 
-	// allocate data for each string too
-	char** stringArray = table->ppData[table->_currentColumn];
-	for (int row = 0; row < table->rowCount; row++, data++) {
-		ALLOCATE_STRING_AND_ON_ERROR_RETURN_VOID(env, stringArray[row], *data, "table strings")
+	// Copy each distinct string, at its first row, into the block following the pointers, and point all the rows
+	// that share it at it.  Once copied, a string's dictionary entry is replaced by its copy for the later rows
+	char* stringData = (char*)&stringArray[table->rowCount];
+	for (int row = 0; row < table->rowCount; row++) {
+		char** slot = rowSlots[row];
+		if (firstRows[row]) {
+			size_t length = strlen(*slot);
+			memcpy(stringData, *slot, length + 1);
+			*slot = stringData;
+			stringData += length + 1;
+		}
+		stringArray[row] = *slot;
 	}
+	free(dictionary.strings);
+	free(rowSlots);
 
 	table->_currentColumn++;
 }
@@ -926,7 +1012,8 @@ void tableAddStringColumn(JNIEnv* env, Table* table, char** data)
 /**
  * This reads data from an allocated space that is rows * width with each string occupying width characters
  * Though the strings are null terminated if there is space, there is no guarantee so an exact number of
- * bytes is copied.  Each string in the Table is allocated maximally.
+ * bytes is copied.  Each string in the Table is allocated maximally, all in one buffer
+ * with the row pointers, so there is only one pointer to release.
  *
  * @note
  * The framework will release all memory associated with
@@ -954,15 +1041,16 @@ void tableAddStringColumn(JNIEnv* env, Table* table, char** data)
  */
 void tableAddFixedWidthStringColumn(JNIEnv* env, Table* table, char* data, int width)
 {
-	tableAddColumn(env, table, AIDA_STRING_ARRAY_TYPE, data, false);
+	char** stringArray = allocateStringTableColumn(env, table, data, table->rowCount * (size_t)(width + 1));
 	ON_EXCEPTION_RETURN_VOID
 
-	// allocate data for each string too
-	char** stringArray = table->ppData[table->_currentColumn];
+	// Copy each fixed width string into the block following the pointers, and point its row at it
+	char* stringData = (char*)&stringArray[table->rowCount];
 	char* dataPointer = (char*)data;
-	for (int row = 0; row < table->rowCount; row++, dataPointer += width) {
-		ALLOCATE_FIXED_LENGTH_STRING_AND_ON_ERROR_RETURN_VOID(env, stringArray[row], dataPointer, width + 1, "table strings")
-		stringArray[row][width] = 0x0;
+	for (int row = 0; row < table->rowCount; row++, dataPointer += width, stringData += width + 1) {
+		memcpy(stringData, dataPointer, width);
+		stringData[width] = 0x0;
+		stringArray[row] = stringData;
 	}
 
 	table->_currentColumn++;
@@ -1207,6 +1295,207 @@ void tableAddSingleRowStringColumn(JNIEnv* env, Table* table, char* data)
 	tableAddStringColumn(env, table, &data);
 }
 
+/**
+ * Make a streaming Table for return to client.  Use this instead of tableCreate() when the number of rows
+ * is not known up front, or the data is produced a row, or a chunk of rows, at a time.
+ * The schema is declared here, one type per column, and the Table starts with no rows.
+ * Rows are then added with tableAppendRow() or tableAppendChunk().  Space for the columns grows as rows are
+ * appended, doubling each time it is used up, and strings are packed into shared blocks,
+ * so no per-row allocation is made.  Each distinct string is stored, and converted to a java String, only once.
+ * The column buffers are handed directly to the client when you return the Table.
+ *
+ * @param env            The JNI environment.  Used in all functions involving JNI.
+ * @param columns        the number of columns to create the Table with.
+ * @param types          the type of each column, an array of @p columns types.
+ * @return the newly created Table
+ *
+ * @see
+ * tableAppendRow(),
+ * tableAppendChunk()
+ *
+ * @paragraph Example
+ *
+ * Create a two column streaming Table, add rows as they are produced, and return.
+ * @code
+ * Type types[] = { AIDA_STRING_TYPE, AIDA_FLOAT_TYPE };
+ *
+ * Table table = tableCreateStreaming(env, 2, types);
+ * ON_EXCEPTION_RETURN_(table)
+ * for (int i = 0; i < nDevices; i++) {
+ *     float value = readValue(devices[i]);
+ *     void* row[] = { &devices[i], &value };
+ *     tableAppendRow(env, &table, row, true);
+ *     ON_EXCEPTION_RETURN_(table)
+ * }
+ * return table;
+ * @endcode
+ * @note
+ * You need to call ON_EXCEPTION_RETURN_(table) after each call to make
+ * sure that no exception was raised.
+ */
+Table tableCreateStreaming(JNIEnv* env, int columns, Type* types)
+{
+	Table table;
+	memset(&table, 0, sizeof(table));
+
+	if (columns <= 0 || !types) {
+		aidaThrowNonOsException(env, AIDA_INTERNAL_EXCEPTION, "Attempt to allocate a streaming table with no columns");
+		return table;
+	}
+
+	// Allocate space for the table columns and column types
+	ALLOCATE_MEMORY_AND_ON_ERROR_RETURN_(env, table.ppData, columns * sizeof(void*), "table columns", table)
+	ALLOCATE_MEMORY_AND_ON_ERROR_RETURN_(env, table.types, columns * sizeof(Type*), "table column types", table)
+	table.columnCount = columns;
+
+	// Declare all the columns up front.  Their space is allocated when rows are appended
+	for (int column = 0; column < columns; column++) {
+		table.ppData[column] = NULL;
+		table.types[column] = tableArrayTypeOf(types[column]);
+	}
+	table._currentColumn = columns;
+
+	for (int column = 0; column < columns; column++) {
+		if (!tableElementSizeOfOf(table.types[column])) {
+			aidaThrowNonOsException(env, UNABLE_TO_GET_DATA_EXCEPTION,
+					"Internal Error: Call to tableCreateStreaming() un-supported type");
+			return table;
+		}
+	}
+
+	return table;
+}
+
+/**
+ * Append a single row to a streaming Table created with tableCreateStreaming().
+ * Each element of @p values points to the value for the corresponding column.  For
+ * string columns this is a pointer to the `char *`.  The values are copied so the caller's
+ * buffers can be reused after calling this function.
+ *
+ * @param env            The JNI environment.  Used in all functions involving JNI.
+ * @param table          the streaming Table to append the row to.
+ * @param values         an array of `table->columnCount` pointers to this row's values.
+ * @param ieeeFormat     true if the floating point values provided are already in ieee format.  If not they will be
+ *        converted, in place, to ieee format.
+ *
+ * @see
+ * tableCreateStreaming(),
+ * tableAppendChunk()
+ */
+void tableAppendRow(JNIEnv* env, Table* table, void** values, bool ieeeFormat)
+{
+	tableAppendChunk(env, table, 1, values, ieeeFormat);
+}
+
+/**
+ * Append a chunk of rows to a streaming Table created with tableCreateStreaming().
+ * Each element of @p data points to a buffer of @p rows values for the corresponding column.  For
+ * string columns this is a buffer of `char *`.  The values are copied so the caller's
+ * buffers can be reused, e.g. for the next chunk, after calling this function.
+ *
+ * @param env            The JNI environment.  Used in all functions involving JNI.
+ * @param table          the streaming Table to append the rows to.
+ * @param rows           the number of rows in this chunk.
+ * @param data           an array of `table->columnCount` pointers to each column's values.
+ * @param ieeeFormat     true if the floating point values provided are already in ieee format.  If not they will be
+ *        converted, in place, to ieee format.
+ *
+ * @see
+ * tableCreateStreaming(),
+ * tableAppendRow()
+ */
+void tableAppendChunk(JNIEnv* env, Table* table, int rows, void** data, bool ieeeFormat)
+{
+	// Streaming table?
+	if (!table->columnCount || table->rowCount > table->_rowCapacity) {
+		aidaThrowNonOsException(env, UNABLE_TO_GET_DATA_EXCEPTION,
+				"Internal Error: Attempt to append rows to a table not created with tableCreateStreaming()");
+		return;
+	}
+
+	// No Data supplied ?
+	if (!data) {
+		aidaThrowNonOsException(env, UNABLE_TO_GET_DATA_EXCEPTION,
+				"Internal Error: Attempt to append rows with no data");
+		return;
+	}
+
+	if (rows <= 0) {
+		return;
+	}
+
+	// Make room for the new rows
+	tableEnsureRowCapacity(env, table, table->rowCount + rows);
+	ON_EXCEPTION_RETURN_VOID
+
+	for (int column = 0; column < table->columnCount; column++) {
+		Type type = table->types[column];
+		void* columnData = data[column];
+
+		if (!columnData) {
+			aidaThrowNonOsException(env, UNABLE_TO_GET_DATA_EXCEPTION,
+					"Internal Error: Attempt to append rows with no data for a column");
+			return;
+		}
+
+		// Strings are copied into the table's string blocks
+		if (type == AIDA_STRING_ARRAY_TYPE) {
+			char** stringArray = &((char**)table->ppData[column])[table->rowCount];
+			for (int row = 0; row < rows; row++) {
+				stringArray[row] = tableCopyString(env, table, ((char**)columnData)[row]);
+				ON_EXCEPTION_RETURN_VOID
+			}
+			continue;
+		}
+
+		if (!ieeeFormat) {
+			// Convert float values if float array
+			if (type == AIDA_FLOAT_ARRAY_TYPE) {
+				CONVERT_FROM_VMS_FLOAT(((float*)columnData), (int2u)rows)
+			}
+
+			// Convert double values if double array
+			if (type == AIDA_DOUBLE_ARRAY_TYPE) {
+				CONVERT_FROM_VMS_DOUBLE((double*)columnData, (int2u)rows)
+			}
+		}
+
+		// Add data to the end of the column
+		size_t elementSize = tableElementSizeOfOf(type);
+		memcpy((char*)table->ppData[column] + table->rowCount * elementSize, columnData, rows * elementSize);
+	}
+
+	table->rowCount += rows;
+}
+
+/**
+ * Hash a string.  FNV-1a.  Use this for the hash tables that providers keep of names, so they all hash alike.
+ *
+ * @param string the string to hash
+ * @return the hash
+ */
+unsigned int aidaHash(const char* string)
+{
+	unsigned int hash = 2166136261u;
+	while (*string) {
+		hash ^= (unsigned char)*string++;
+		hash *= 16777619u;
+	}
+	return hash;
+}
+
+/**
+ * Get the time now, e.g. to time stamp cached values and to find their age.
+ *
+ * @return the time now, in seconds since the epoch, to the microsecond
+ */
+double aidaTimeNow(void)
+{
+	struct timeval now;
+	gettimeofday(&now, NULL);
+	return now.tv_sec + now.tv_usec / 1000000.0;
+}
+
 /**
  * See if there is a ieee float value stored in arguments.  If so set target
  *
@@ -1702,6 +1991,178 @@ static void allocateTableColumn(JNIEnv* env, Table* table, Type aidaType, size_t
 	table->ppData[table->_currentColumn] = ALLOCATE_MEMORY(env, table->rowCount * elementSize, "table data");
 }
 
+/**
+ * Add a string column to a Table allocating the row pointers and the given
+ * amount of space for the strings themselves in one contiguous block.
+ * The strings are laid out immediately after the `table->rowCount` row pointers.
+ *
+ * @param table the Table to add the column to
+ * @param data the data that will be added to the column, checked only for presence
+ * @param stringDataSize the total space required for the strings including their null terminators
+ * @return the row pointers of the new column
+ */
+static char** allocateStringTableColumn(JNIEnv* env, Table* table, void* data, size_t stringDataSize)
+{
+	// Table full?
+	if (table->_currentColumn >= table->columnCount) {
+		aidaThrowNonOsException(env, UNABLE_TO_GET_DATA_EXCEPTION,
+				"Internal Error: more columns added than table size");
+		return NULL;
+	}
+
+	// No Data supplied ?
+	if (!data) {
+		aidaThrowNonOsException(env, UNABLE_TO_GET_DATA_EXCEPTION,
+				"Internal Error: Attempt to add column with no data");
+		return NULL;
+	}
+
+	table->types[table->_currentColumn] = AIDA_STRING_ARRAY_TYPE;
+	table->ppData[table->_currentColumn] = ALLOCATE_MEMORY(env,
+			table->rowCount * sizeof(char*) + stringDataSize, "table strings");
+	return (char**)table->ppData[table->_currentColumn];
+}
+
+/**
+ * Make sure that each column of a streaming Table has space for at least the given number of rows.
+ * Space is doubled each time it is used up so that appending rows one at a time is amortised.
+ *
+ * @param table the streaming Table
+ * @param rows the number of rows required
+ */
+static void tableEnsureRowCapacity(JNIEnv* env, Table* table, int rows)
+{
+	if (rows <= table->_rowCapacity) {
+		return;
+	}
+
+	int rowCapacity = table->_rowCapacity ? table->_rowCapacity : MIN_TABLE_ROW_ALLOCATIONS;
+	while (rowCapacity < rows) {
+		rowCapacity *= 2;
+	}
+
+	for (int column = 0; column < table->columnCount; column++) {
+		void* columnData = realloc(table->ppData[column], rowCapacity * tableElementSizeOfOf(table->types[column]));
+		if (!columnData) {
+			aidaThrowNonOsException(env, AIDA_INTERNAL_EXCEPTION, "Could not allocate space for table data");
+			return;
+		}
+		table->ppData[column] = columnData;
+	}
+
+	table->_rowCapacity = rowCapacity;
+}
+
+/**
+ * Copy the given string into the string blocks of a streaming Table, allocating a new
+ * block, twice the size of the last, if there is not enough space left.
+ * If the Table already holds the same string then that copy is returned instead, so
+ * each distinct string is stored once.
+ *
+ * @param table the streaming Table
+ * @param string the string to copy.  NULL is stored as an empty string
+ * @return the copy of the string
+ */
+static char* tableCopyString(JNIEnv* env, Table* table, const char* string)
+{
+	if (!string) {
+		string = "";
+	}
+
+	// If the string is already in the table then share it
+	if (tableDictionaryReserve(&table->_stringDictionary, table->_stringDictionary.count + 1)) {
+		aidaThrowNonOsException(env, AIDA_INTERNAL_EXCEPTION, "Could not allocate space for table string dictionary");
+		return NULL;
+	}
+	char** slot = tableDictionarySlot(&table->_stringDictionary, string);
+	if (*slot) {
+		return *slot;
+	}
+
+	size_t length = strlen(string);
+	TableStringBlock* block = table->_stringBlocks;
+
+	if (!block || block->used + length + 1 > block->size) {
+		size_t size = block ? block->size * 2 : MIN_TABLE_STRING_BLOCK_SIZE;
+		if (size < length + 1) {
+			size = length + 1;
+		}
+
+		TableStringBlock* newBlock = ALLOCATE_MEMORY(env, sizeof(TableStringBlock) + size, "table strings");
+		if (!newBlock) {
+			return NULL;
+		}
+		newBlock->next = block;
+		newBlock->size = size;
+		newBlock->used = 0;
+		table->_stringBlocks = block = newBlock;
+	}
+
+	char* copy = &block->data[block->used];
+	memcpy(copy, string, length + 1);
+	block->used += length + 1;
+
+	// Add to the dictionary
+	*slot = copy;
+	table->_stringDictionary.count++;
+
+	return copy;
+}
+
+/**
+ * Find the slot in the given dictionary that holds the given string,
+ * or the empty slot where it should be added if it is not there.
+ * The dictionary must have at least one empty slot.
+ *
+ * @param dictionary the dictionary
+ * @param string the string to look for
+ * @return the slot
+ */
+static char** tableDictionarySlot(TableStringDictionary* dictionary, const char* string)
+{
+	unsigned int mask = dictionary->size - 1;
+	for (unsigned int i = aidaHash(string) & mask;; i = (i + 1) & mask) {
+		if (!dictionary->strings[i] || strcmp(dictionary->strings[i], string) == 0) {
+			return &dictionary->strings[i];
+		}
+	}
+}
+
+/**
+ * Make sure that the given dictionary can hold the given number of strings while staying
+ * no more than half full, doubling its size, and re-adding its strings, if it can't.
+ *
+ * @param dictionary the dictionary
+ * @param count the number of strings it needs to hold
+ * @return EXIT_SUCCESS if there is room, EXIT_FAILURE if the space could not be allocated
+ */
+static int tableDictionaryReserve(TableStringDictionary* dictionary, int count)
+{
+	if (count * 2 <= dictionary->size) {
+		return EXIT_SUCCESS;
+	}
+
+	int size = dictionary->size ? dictionary->size : MIN_TABLE_DICTIONARY_SIZE;
+	while (size < count * 2) {
+		size *= 2;
+	}
+
+	TableStringDictionary resized = { calloc(size, sizeof(char*)), size, dictionary->count };
+	if (!resized.strings) {
+		return EXIT_FAILURE;
+	}
+
+	for (int i = 0; i < dictionary->size; i++) {
+		if (dictionary->strings[i]) {
+			*tableDictionarySlot(&resized, dictionary->strings[i]) = dictionary->strings[i];
+		}
+	}
+
+	free(dictionary->strings);
+	*dictionary = resized;
+	return EXIT_SUCCESS;
+}
+
 /**
  * Determine if the given string value is a boolean value
  * @param stringValue string value
@@ -16,6 +16,23 @@ extern "C" {
  */
 #define MIN_FLOAT_ALLOCATIONS 100
 
+/**
+ * Minimum number of rows allocated for each column of a streaming Table.  When rows are appended the framework
+ * doubles the allocated space each time it is used up, starting from this size.
+ */
+#define MIN_TABLE_ROW_ALLOCATIONS 64
+
+/**
+ * Minimum size of each block of string storage for a streaming Table.  Each new block is twice the size of the previous one.
+ */
+#define MIN_TABLE_STRING_BLOCK_SIZE 4096
+
+/**
+ * Minimum number of slots in the dictionary of distinct strings of a Table.  The dictionary is doubled in size
+ * whenever it becomes half full.
+ */
+#define MIN_TABLE_DICTIONARY_SIZE 64
+
 /**
  * int format definition character for ascanf() and avscanf().
  */
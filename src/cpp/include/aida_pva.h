@@ -96,6 +96,25 @@ int endsWith(const char* str, char* suffix);
  */
 int startsWith(const char* str, char* prefix);
 
+/**
+ * Hash a string.  FNV-1a.  Use this for the hash tables that providers keep of names, so they all hash alike.
+ *
+ * @param string the string to hash
+ * @return the hash
+ */
+unsigned int aidaHash(const char* string);
+
+/////////////////////////////////
+/// Time
+/////////////////////////////////
+
+/**
+ * Get the time now, e.g. to time stamp cached values and to find their age.
+ *
+ * @return the time now, in seconds since the epoch, to the microsecond
+ */
+double aidaTimeNow(void);
+
 /////////////////////////////////
 /// URI Handling for group, secn, pmu and slacName
 /////////////////////////////////
@@ -374,6 +393,28 @@ Table tableCreateDynamic(JNIEnv* env, int rows, int columns);
  */
 void tableAddColumn(JNIEnv* env, Table* table, Type type, void* data, bool ieeeFormat);
 
+/**
+ * Add a column of arbitrary type to a Table, and return its data buffer for the
+ * caller to fill in directly, instead of presenting a buffer to be copied.
+ * Use this when the data has to be converted, or unpacked from a backend buffer, anyway,
+ * so that it is written straight into the column rather than into an intermediate array that
+ * tableAddColumn() would copy again.  The buffer has `table->rowCount` elements of the
+ * column's type, and the values written to it must already be in ieee format.
+ *
+ * @note
+ * Don't call this to add strings to the Table.  Use tableAddStringColumn() for that.
+ *
+ * @param env            The JNI environment.  Used in all functions involving JNI.
+ * @param table          the Table to add the column to.
+ * @param type           the type of this Table column.
+ * @return the column's data buffer, or NULL if an exception has been raised
+ *
+ * @see
+ * tableCreate(),
+ * tableAddColumn()
+ */
+void* tableAddEmptyColumn(JNIEnv* env, Table* table, Type type);
+
 /**
  * Add a dynamic field to a table.
  *
@@ -399,8 +440,9 @@ void tableAddLabel(JNIEnv* env, Table* table, char* labelName);
 /**
  * Add a String column to the given Table.
  * This reads data from a buffer that is itself a list of pointers to strings.
- * We allocate just enough space to store the strings in our Table.  This is allocated
- * in one buffer so there is only one pointer to release.
+ * We allocate just enough space to store the distinct strings in our Table.  This is allocated
+ * in one buffer, the row pointers followed by the strings themselves, so there is only one pointer to release.
+ * Rows with the same string share one copy of it, so that it is only converted to a java String once.
  *
  * @note
  * The framework will release all memory associated with
@@ -448,7 +490,8 @@ void tableAddStringColumn(JNIEnv* env, Table* table, char** data);
  * Add fixed-width string data to a column in the given Table.
  * This reads data from an allocated space that is rows * width with each string occupying width characters
  * Though the strings are null terminated if there is space, there is no guarantee so an exact number of
- * bytes is copied.  Each string in the Table is allocated maximally.
+ * bytes is copied.  Each string in the Table is allocated maximally, all in one buffer
+ * with the row pointers, so there is only one pointer to release.
  *
  * @note
  * The framework will release all memory associated with
@@ -691,6 +734,83 @@ void tableAddSingleRowDoubleColumn(JNIEnv* env, Table* table, double data, bool
  */
 void tableAddSingleRowStringColumn(JNIEnv* env, Table* table, char* data);
 
+/**
+ * Make a streaming Table for return to client.  Use this instead of tableCreate() when the number of rows
+ * is not known up front, or the data is produced a row, or a chunk of rows, at a time.
+ * The schema is declared here, one type per column, and the Table starts with no rows.
+ * Rows are then added with tableAppendRow() or tableAppendChunk().  Space for the columns grows as rows are
+ * appended, doubling each time it is used up, and strings are packed into shared blocks,
+ * so no per-row allocation is made.  Each distinct string is stored, and converted to a java String, only once.
+ * The column buffers are handed directly to the client when you return the Table.
+ *
+ * @param env            The JNI environment.  Used in all functions involving JNI.
+ * @param columns        the number of columns to create the Table with.
+ * @param types          the type of each column, an array of @p columns types.
+ * @return the newly created Table
+ *
+ * @see
+ * tableAppendRow(),
+ * tableAppendChunk()
+ *
+ * @paragraph Example
+ *
+ * Create a two column streaming Table, add rows as they are produced, and return.
+ * @code
+ * Type types[] = { AIDA_STRING_TYPE, AIDA_FLOAT_TYPE };
+ *
+ * Table table = tableCreateStreaming(env, 2, types);
+ * ON_EXCEPTION_RETURN_(table)
+ * for (int i = 0; i < nDevices; i++) {
+ *     float value = readValue(devices[i]);
+ *     void* row[] = { &devices[i], &value };
+ *     tableAppendRow(env, &table, row, true);
+ *     ON_EXCEPTION_RETURN_(table)
+ * }
+ * return table;
+ * @endcode
+ * @note
+ * You need to call ON_EXCEPTION_RETURN_(table) after each call to make
+ * sure that no exception was raised.
+ */
+Table tableCreateStreaming(JNIEnv* env, int columns, Type* types);
+
+/**
+ * Append a single row to a streaming Table created with tableCreateStreaming().
+ * Each element of @p values points to the value for the corresponding column.  For
+ * string columns this is a pointer to the `char *`.  The values are copied so the caller's
+ * buffers can be reused after calling this function.
+ *
+ * @param env            The JNI environment.  Used in all functions involving JNI.
+ * @param table          the streaming Table to append the row to.
+ * @param values         an array of `table->columnCount` pointers to this row's values.
+ * @param ieeeFormat     true if the floating point values provided are already in ieee format.  If not they will be
+ *        converted, in place, to ieee format.
+ *
+ * @see
+ * tableCreateStreaming(),
+ * tableAppendChunk()
+ */
+void tableAppendRow(JNIEnv* env, Table* table, void** values, bool ieeeFormat);
+
+/**
+ * Append a chunk of rows to a streaming Table created with tableCreateStreaming().
+ * Each element of @p data points to a buffer of @p rows values for the corresponding column.  For
+ * string columns this is a buffer of `char *`.  The values are copied so the caller's
+ * buffers can be reused, e.g. for the next chunk, after calling this function.
+ *
+ * @param env            The JNI environment.  Used in all functions involving JNI.
+ * @param table          the streaming Table to append the rows to.
+ * @param rows           the number of rows in this chunk.
+ * @param data           an array of `table->columnCount` pointers to each column's values.
+ * @param ieeeFormat     true if the floating point values provided are already in ieee format.  If not they will be
+ *        converted, in place, to ieee format.
+ *
+ * @see
+ * tableCreateStreaming(),
+ * tableAppendRow()
+ */
+void tableAppendChunk(JNIEnv* env, Table* table, int rows, void** data, bool ieeeFormat);
+
 /////////////////////////////////
 /// Argument Processing
 /////////////////////////////////
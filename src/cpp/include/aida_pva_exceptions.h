@@ -56,6 +56,22 @@ extern "C" {
         return _r; \
     }
 
+/**
+ * Check to see if an exception has been raised,
+ * pop the current local reference frame,
+ * and return the given return value.
+ *
+ * Uses local variable `env` for checking exception status.
+ *
+ * @param _r the specified return value.
+ * @return This MACRO will return the specified return value from your function if there has been an exception.
+ */
+#define ON_EXCEPTION_POP_LOCAL_FRAME_AND_RETURN_(_r) \
+    if ((*env)->ExceptionCheck(env)) { \
+        (*env)->PopLocalFrame(env, NULL); \
+        return _r; \
+    }
+
 /**
  * Check to see if an exception has been raised,
  * then free tracked memory,
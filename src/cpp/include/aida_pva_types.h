@@ -131,6 +131,34 @@ typedef struct
 	FloatingPointValue* floatingPointValues;        ///< The array of FloatingPointValue
 } Arguments;
 
+/**
+ * A block of string storage for a streaming Table.
+ * Strings appended to a streaming Table are packed into these blocks so that
+ * each string does not need its own allocation.  Blocks are chained, newest first,
+ * and never move once allocated so the Table's string column pointers remain valid
+ * as the Table grows.
+ */
+typedef struct TableStringBlock
+{
+	struct TableStringBlock* next;  ///< The previously allocated block, or NULL
+	size_t size;                    ///< The number of bytes available in data
+	size_t used;                    ///< The number of bytes of data used so far
+	char data[];                    ///< The packed, null terminated, strings
+} TableStringBlock;
+
+/**
+ * A dictionary of the distinct strings in a Table.
+ * Strings added to a Table are looked up here, by value, so that each distinct string is stored only once
+ * and all the rows that share a value point to the same string.  This lets toTable()
+ * create each distinct java String only once.  It is an open addressed hash set whose size is a power of two.
+ */
+typedef struct
+{
+	char** strings;                 ///< The distinct strings, NULL for an empty slot
+	int size;                       ///< The number of slots in strings
+	int count;                      ///< The number of slots used
+} TableStringDictionary;
+
 /**
  * Table structure.
  * This structure holds everything that a Native Channel Provider needs for returning a Table
@@ -153,6 +181,9 @@ typedef struct
  *  - tableAddSingleRowStringColumn()
  *  - tableAddFixedWidthStringColumn()
  *  - tableAddStringColumn()
+ *
+ * Tables whose row count is not known up front are created with tableCreateStreaming() and
+ * filled with tableAppendRow() and tableAppendChunk().
  */
 typedef struct
 {
@@ -165,6 +196,9 @@ typedef struct
 	int _currentColumn;     ///< For internal use by addColumn() etc
 	int _currentField;      ///< For internal use by addField() etc
 	int _currentLabel;      ///< For internal use by addLabel() etc
+	int _rowCapacity;       ///< For internal use by tableAppendRow() etc.  Rows allocated in each column of a streaming table
+	TableStringBlock* _stringBlocks;  ///< For internal use by tableAppendRow() etc.  Blocks holding the strings of a streaming table
+	TableStringDictionary _stringDictionary;  ///< For internal use by tableAppendRow() etc.  The distinct strings of a streaming table
 } Table;
 
 /**
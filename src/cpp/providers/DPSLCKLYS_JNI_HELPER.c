@@ -370,6 +370,136 @@ egress:
 	return iss;
 }
 
+/* ================================================================================
+
+  Abs:  Get the status codes for a list of klystrons on the
+        specified beam code.
+
+  Name: DPSLCKLYS_GETSTATUSES
+
+  Args:
+        count                        The number of klystrons.
+          Use:   integer
+          Type:  int
+          Acc:   read-only
+          Mech:  value
+
+        slcnames                     The specified klystrons, each
+          Use:   string array        identified by a primary:micro:unit
+          Type:  char **             string.
+          Acc:   read-only
+          Mech:  reference
+
+        beam                         A string containing the specified
+          Use:   string              beam code number.
+          Type:  char *
+          Acc:   read-only
+          Mech:  reference
+
+        dgrp                         A string containing a display
+          Use:   string              group name or "NULL" if a
+          Type:  char *              display group was not specified.
+          Acc:   read-only
+          Mech:  reference
+
+        klys_statuses                The output status code of each
+          Use:   short array         klystron, 0 if it was not obtained.
+          Type:  short *
+          Acc:   write-only
+          Mech:  reference
+
+        iss_statuses                 The output vmsstat_t of each
+          Use:   vmsstat_t array     klystron's status request.
+          Type:  vmsstat_t *
+          Acc:   write-only
+          Mech:  reference
+
+  Rem:  This routine obtains the status code of each of the
+        specified klystrons as DPSLCKLYS_GETSTATUS does for one,
+        but converts the beam code and display group only once
+        for the whole list.  The status codes are returned in
+        the order the klystrons are given.  linac_klys_stat is
+        called once for each klystron as it only takes one.
+
+  Side: none
+
+  Ret:  The number of klystrons whose status code was obtained.
+
+==============================================================================*/
+
+int DPSLCKLYS_GETSTATUSES(int count,
+		char** slcnames,
+		char* beam,
+		char* dgrp,
+		short* klys_statuses,
+		vmsstat_t* iss_statuses)
+{
+	int i;
+	int n_obtained = 0;
+
+	int4 beam_i;
+
+	prim_name_ts prim_s;            /* Device primary */
+	micr_name_ts micr_s;            /* Device micro */
+	unit_name_ts unit_s;            /* Device unit */
+
+	dgrp_name_ta dgrp_a;
+	dgrp_name_ta* dgrp_pa = NULL;
+
+	KLYS_STATUS_TS klys_status_s;   /* Standard list */
+
+/*---------------------------------------------------*/
+#ifdef DEBUG
+	fprintf(stderr, "entering DPSLCKLYS_GETSTATUSES\n");
+	fprintf(stderr, "count = %d\n", count);
+	fprintf(stderr, "beam = %s\n", beam);
+	fprintf(stderr, "dgrp = %s\n", dgrp);
+#endif
+
+	/* Convert the beam code and display group once for all
+	   of the klystrons.
+	------------------------------------------------------- */
+	sscanf((const char*)beam, "%d", &beam_i);
+
+	if (strcmp(dgrp, "NULL") != 0)
+	{
+		strncpy(dgrp_a, dgrp, 8);
+		dgrp_pa = &dgrp_a;
+	}
+
+	for (i = 0; i < count; i++)
+	{
+		/* Parse the klystron primary:micro:unit string
+		   to primary, micro, unit fields.
+		----------------------------------------------- */
+		parseDeviceName(slcnames[i], &prim_s, &micr_s, &unit_s);
+
+		klys_status_s.list_length = 3;
+		klys_status_s.data_length = 0;
+
+		iss_statuses[i] = linac_klys_stat((void*)&klys_status_s,
+				(void*)micr_s._a,
+				(void*)unit_s._a,
+				&beam_i,
+				(void*)dgrp_pa);
+		if (!SUCCESS(iss_statuses[i]))
+		{
+			fprintf(stderr, "return from linac_klys_stat for %s = %x\n", slcnames[i], iss_statuses[i]);
+			klys_statuses[i] = 0;
+			continue;
+		}
+
+#ifdef DEBUG
+		fprintf(stderr, "%s klys_status_s.data = %x\n", slcnames[i], klys_status_s.data);
+#endif
+
+		klys_statuses[i] = klys_status_s.data;
+		n_obtained++;
+	}
+
+	return n_obtained;
+}
+
 /* ============================================================================`
 
   Abs:  Determine whether Klystron Aida access is enabled
@@ -850,6 +980,125 @@ egress:
 	return iss;
 }
 
+/*=============================================================================
+
+  Abs:  Set the PDES or KPHR secondary values of a list of subboosters
+        or klystrons, optionally trimming the phase if the secondary
+        is PDES, and obtain their PHAS secondary readback values.
+
+  Name: DPSLCKLYS_SETTRIMPHASES
+
+  Args: count                        Number of specified primary/micro/unit
+          Use:   integer             devices.
+          Type:  int
+          Acc:   read-only
+          Mech:  value
+
+        prim_list                    List of specified primary names.
+          Use:   string
+          Type:  char *
+          Acc:   read-only
+          Mech:  reference
+
+        micr_list                    List of specified micro names.
+          Use:   string
+          Type:  char *
+          Acc:   read-only
+          Mech:  reference
+
+        unit_list                    List of specified unit numbers.
+          Use:   integer pointer
+          Type:  int *
+          Acc:   read-only
+          Mech:  reference
+
+        secn                         The secondary to be set: either
+          Use:   char-string         PDES or KPHR.
+          Type:  char *
+          Acc:   read-only
+          Mech:  reference
+
+        set_values                   The list of values to set each of
+          Use:   float *             the given device's secondaries to,
+          Type:  float *             in VMS format.
+          Acc:   read-only
+          Mech:  reference
+
+        trim                         Flag indicating whether to trim
+          Use:   char-string         the phase (YES or NO) if the
+          Type:  char *              secondary is PDES.
+          Acc:   read-only
+          Mech:  reference
+
+        phas_values                  The list of PHAS secondary readback
+          Use:   float *             values of each device after its
+          Type:  float *             trim operation, in IEEE format, 0
+          Acc:   write-only          for devices that could not be set.
+          Mech:  reference
+
+        iss_statuses                 The list of returned status codes
+          Use:   vmsstat_t *         of each device's set operation.
+          Type:  vmsstat_t *
+          Acc:   write-only
+          Mech:  reference
+
+  Rem:  This routine sets the PDES or KPHR secondary value of each of
+        the specified devices by calling DPSLCKLYS_SETTRIMPHASE for
+        each device in turn, as klystrim_one only takes one device.
+        It saves no backend round trips.  A failure on one device
+        does not stop the others from being set.
+
+  Side: none
+
+  Ret:  The number of devices successfully set.
+
+==============================================================================*/
+
+int DPSLCKLYS_SETTRIMPHASES(int count,
+		char* prim_list,
+		char* micr_list,
+		int* unit_list,
+		char* secn,
+		float* set_values,
+		char* trim,
+		float* phas_values,
+		vmsstat_t* iss_statuses)
+{
+	int i;
+	int set_count = 0;
+
+	char pmu_str[MAX_PRIM_NAME_LEN + MAX_MICR_NAME_LEN + 14];   /* Device primary:micro:unit */
+
+/*---------------------------------------------------*/
+
+#ifdef DEBUG
+	fprintf(stderr, "entering DPSLCKLYS_SETTRIMPHASES\n");
+	fprintf(stderr, "count = %d\n", count);
+#endif
+
+	/* Set each device in turn, klystrim_one only takes one device.
+	--------------------------------------------------------------- */
+	for (i = 0; i < count; i++)
+	{
+		sprintf(pmu_str, "%.*s:%.*s:%d",
+				MAX_PRIM_NAME_LEN, prim_list + (i * MAX_PRIM_NAME_LEN),
+				MAX_MICR_NAME_LEN, micr_list + (i * MAX_MICR_NAME_LEN),
+				unit_list[i]);
+
+		iss_statuses[i] = DPSLCKLYS_SETTRIMPHASE(pmu_str, secn, &set_values[i], trim, &phas_values[i]);
+		if (SUCCESS(iss_statuses[i]))
+		{
+			set_count++;
+		}
+		else
+		{
+			phas_values[i] = 0.0;
+		}
+	}
+
+	return set_count;
+}
+
 /* ================================================================================
 
   Abs:  Set multiple secondary values for primary/micro/unit sub-boosters
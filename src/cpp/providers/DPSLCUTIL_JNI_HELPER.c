@@ -37,6 +37,8 @@
 #include <ctype.h>                /* isalnum, ispunct */
 #include <descrip.h>              /* descriptor definitions */
 #include <starlet.h>              /* for sys$asctim() */
+#include <time.h>                 /* time */
+#include <sys/stat.h>             /* stat */
 
 #include "slctxt:slc_macros.h"    /* vmsstat_t, int2u, int4u, etc. */
 #include "descr.h"                /* descriptor macros */
@@ -94,12 +96,15 @@ vmsstat_t tm_reactivate(int * prim,
 #define SECN_LEN_NAME 4
 #define MAX_UNIT_NUM_LEN 5
 #define MAX_DEVICE_STRING_LEN 20
+#define MAX_MKB_FILE_LEN 255
+#define MKB_SESSION_IDLE_EXPIRY 300 /* seconds a knob session may be idle */
 
 #define MEMORY_ALLOCATE_FAIL     2
 #define NO_BGRP_NAMES            4
 #define BGRP_NAME_NOT_FOUND      6
 #define NO_BGRP_VARIABLES        8
 #define BGRP_VARIABLE_NOT_FOUND 10
+#define BAD_DEVICE_NAME         12
 
 /*
 #define DEBUG
@@ -135,6 +140,31 @@ static char *mkb_device_names = NULL;
 --------------------------------------------------------- */
 static float *mkb_secn_values = NULL;
 
+/* Definition of the last multiknob file parsed, as returned
+   by mkbhst_get_knobdef, and the file name and modification
+   time it was parsed from.  The file name is empty if no
+   definition is cached.
+------------------------------------------------------------ */
+static mkbhst_data_ts mkb_knobdef;
+static char mkb_knobdef_file[MAX_MKB_FILE_LEN + 1];
+static time_t mkb_knobdef_mtime;
+
+/* Indication of whether a multiknob file is still assigned in a
+   knob session, the name of the file, and the time of the last
+   step of the session.  The name is kept whether or not the
+   file's definition could be cached.
+----------------------------------------------------------------- */
+static int mkb_session_assigned;
+static char mkb_session_file[MAX_MKB_FILE_LEN + 1];
+static time_t mkb_session_last_step;
+
+/* Indication of whether mkb_device_names, mkb_secn_values, and
+   the database list used to retrieve the secondary values have
+   been formed for the multiknob file definition in mkb_knobdef.
+---------------------------------------------------------------- */
+static int mkb_devices_listed;
+static DBLIST(mkb_db_list_ps, int2u);
+
 /*
 ** Static Function Prototype(s)
 */
@@ -147,6 +177,16 @@ static void parseDeviceName(char *slcname,
         micr_name_ts *micr_ps,
         unit_name_ts *unit_ps);
 
+static vmsstat_t mkbEndSession(void);
+
+static void mkbExpireSession(time_t now);
+
+static vmsstat_t mkbListDevices(void);
+
+static vmsstat_t mkbReadSecnValues(void);
+
+static void mkbFreeDevices(void);
+
 
 /* ================================================================================
 
@@ -208,6 +248,11 @@ int DPSLCUTIL_MKB_ACCESSENABLED ()
 
 /*---------------------------------------------------*/
 
+    /* Every multiknob request starts here, so a knob session that
+       has been idle for too long is released now.
+    -------------------------------------------------------------- */
+    mkbExpireSession(time(NULL));
+
     status = chk_aida_access(DESCRN1( ((void *)
                     (multiknob_access_logical_name)) ),
             &enabled_flag,
@@ -242,17 +287,38 @@ int DPSLCUTIL_MKB_ACCESSENABLED ()
           Acc:   write-only
           Mech:  reference
 
+        session                        TRUE to keep the knob assigned
+          Use:   integer               after the rotation, for the
+          Type:  int                   next step of a knob session.
+          Acc:   read-only
+          Mech:  value
+
   Rem:  Performs multiknob assign, rotate, and deassign operations
         for a specified multiknob file and relative delta knob
         rotation value.
 
+        The definition of the multiknob file is cached, keyed by
+        file name and modification time, so the parse only assign
+        and the call to mkbhst_get_knobdef are skipped while the
+        file is unchanged.  In a knob session the knob is left
+        assigned after the rotation, so consecutive steps on the
+        same unchanged file are just rotations.  The session is
+        ended, with a deassign, by a step without session, by
+        DPSLCUTIL_MKB_ENDSESSION, by a step on another file, when
+        the file is modified or its modification time can't be
+        found, or by the first multiknob call after the session has
+        been idle for more than MKB_SESSION_IDLE_EXPIRY seconds
+        (see mkbExpireSession).  A session can't be kept for a file
+        name longer than MAX_MKB_FILE_LEN, so that step deassigns.
+
   Side: Stores an array of device name strings in dynamically
         allocated pointer mkb_device_names, which is static.  Also
         stores an array of device name secondary values in
         dynamically allocated pointer mkb_secn_values, which is
         also static.  Both the mkb_device_names and mkb_secn_values
-        dynamic arrays must be later freed (e.g., by a call to
-        DPSLCUTIL_MKB_CLEANUP).  Also stores the number of
+        dynamic arrays are kept with the cached multiknob file
+        definition, or must be later freed by a call to
+        DPSLCUTIL_MKB_GETCLEANUP if it isn't cached.  Also stores the number of
         device names in the specified multiknob file in static
         integer variable mkb_num_devices and an indication of
         whether the the specified multiknob file is "absolute"
@@ -264,17 +330,12 @@ int DPSLCUTIL_MKB_ACCESSENABLED ()
 
 vmsstat_t DPSLCUTIL_DO_MKB (char *mkb_file,
         float *relative_delta_array,
-        int *file_num_devices)
+        int *file_num_devices,
+        int session)
 {
     vmsstat_t status;
     vmsstat_t iss;
 
-    int i;
-    int j;
-    int device_name_index; /* Current index into mkb_device_names */
-    int num_leading_blanks;  /* Number of leading blanks in front of unit */
-    int num_unit_digits;     /* Number of digits in unit */
-
     int4  parse_only;
 
     int4u crrknob_num; /* crr knob number */
@@ -283,21 +344,10 @@ vmsstat_t DPSLCUTIL_DO_MKB (char *mkb_file,
 
     float relative_delta_value; /* specified value */
 
-    int4u prim;
-    int4u micr;
-    int4u unit;
-    int4u secn;
-
-    char primary[PRIM_LEN_NAME + 1];
-    char micro[MICR_LEN_NAME + 1];
-    char secondary[SECN_LEN_NAME + 1];
-    char cur_device_name[MAX_DEVICE_STRING_LEN + 1];
-    char unit_buf[MAX_UNIT_NUM_LEN + 1];   /* Unit number buffer */
-
-    mkbhst_data_ts mkbhst_data; /* for retrieving data parsed by MKB routines */
-
-    DBLIST(db_list_ps, int2u); /* Database list data struct */
-    DBLIST(db_float_data_ps, float); /* Database float data */
+    struct stat file_stat; /* for the multiknob file modification time */
+    int file_found;        /* the multiknob file's modification time was found */
+    int knobdef_cached;    /* mkb_knobdef holds the multiknob file's definition */
+    time_t now;
 
     DESCR_DECLARE;
 
@@ -316,271 +366,699 @@ vmsstat_t DPSLCUTIL_DO_MKB (char *mkb_file,
 
     relative_delta_value = relative_delta_array[0];
 
-    /* Perform needed multiknob initialization.
-    ------------------------------------------- */
-    mkb_initialise();
+    /* The cached definition of the multiknob file is used if
+       the file has not been modified since it was parsed.
+    ---------------------------------------------------------- */
+    now = time(NULL);
+    mkbExpireSession(now);
+    file_found = (stat(mkb_file, &file_stat) == 0);
+    knobdef_cached = (file_found &&
+            strcmp(mkb_knobdef_file, mkb_file) == 0 &&
+            file_stat.st_mtime == mkb_knobdef_mtime);
+
+    /* End a knob session that can't be continued because it is
+       for another (or a modified) multiknob file.
+    ------------------------------------------------------------ */
+    if (mkb_session_assigned && (!knobdef_cached ||
+            strcmp(mkb_session_file, mkb_file) != 0))
+    {
+        mkbEndSession();
+    }
 
-    /* Call mkb_set_knobfile for specifying the multiknob
-       file.
-    ----------------------------------------------------- */
-    iss = mkb_set_knobfile(DESCRN1( ((void *) (mkb_file)) ) );
-    if (!SUCCESS(iss))
+    if (!knobdef_cached)
     {
-        fprintf(stderr, "return from mkb_set_knobfile = %x\n", iss);
-        status = iss;
+        mkb_knobdef_file[0] = '\0';
+    }
+    else if (mkb_knobdef.absolute_knob_function)
+    {
+        /* A cached absolute multiknob file is refused without
+           assigning it again.
+        ------------------------------------------------------ */
+        mkb_absolute_multiknob_file = mkb_knobdef.absolute_knob_function;
         goto egress;
     }
 
     crrknob_num = CRRKNOB_NUM;
 
-    /* Just parse the multiknob file as a prerequisite
-       to the later call to mkbhst_get_knobdef.  If we
-       perform the actual assign operation instead of
-       just parsing, error messages may be generated
-       because the multiknob file is absolute (which
-       we cannot determine until mkbhst_get_knobdef
-       is called).
-    --------------------------------------------------- */
-    knobfunc = KNOB_INIT;
+    /* The knob is still assigned if a knob session is being
+       continued, so only the knob rotation is needed.
+    -------------------------------------------------------- */
+    if (!mkb_session_assigned)
+    {
+        /* Perform needed multiknob initialization.
+        ------------------------------------------- */
+        mkb_initialise();
+
+        /* Call mkb_set_knobfile for specifying the multiknob
+           file.
+        ----------------------------------------------------- */
+        iss = mkb_set_knobfile(DESCRN1( ((void *) (mkb_file)) ) );
+        if (!SUCCESS(iss))
+        {
+            fprintf(stderr, "return from mkb_set_knobfile = %x\n", iss);
+            status = iss;
+            goto egress;
+        }
 
-    dummy_zero = 0;
-    parse_only = PARSE_ONLY;
+        if (!knobdef_cached)
+        {
+            /* Just parse the multiknob file as a prerequisite
+               to the later call to mkbhst_get_knobdef.  If we
+               perform the actual assign operation instead of
+               just parsing, error messages may be generated
+               because the multiknob file is absolute (which
+               we cannot determine until mkbhst_get_knobdef
+               is called).
+            --------------------------------------------------- */
+            knobfunc = KNOB_INIT;
+
+            dummy_zero = 0;
+            parse_only = PARSE_ONLY;
+
+            iss = mkb_crrdrvr(&crrknob_num, &knobfunc,
+                    &relative_delta_value, &dummy_zero, &parse_only);
+            if (!SUCCESS(iss))
+            {
+                fprintf(stderr, "return from parse only KNOB_INIT mkb_crrdrvr = %x\n",
+                        iss);
+                status = iss;
+                goto egress;
+            }
+
+            /* Get the multiknob file contents, stored in the
+               static structure instance mkb_knobdef.  Store an
+               indication of whether the absolute_knob_function
+               element of this structure indicates that the
+               specified multiknob file has the "absolute" flag
+               set.  If this "absolute" flag is set, perform the
+               deassign operation and exit.  Otherwise, other
+               elements of this structure will be used later
+               in extracting the device names contained in the
+               file.
+            ---------------------------------------------------- */
+            mkb_devices_listed = FALSE;
+
+            iss = mkbhst_get_knobdef(&mkb_knobdef);
+            if (!SUCCESS(iss))
+            {
+                fprintf(stderr, "return from mkbhst_get_knobdef = %x\n", iss);
+                status = iss;
+
+                knobfunc = KNOB_END;
+
+                iss = mkb_crrdrvr(&crrknob_num, &knobfunc,
+                        &relative_delta_value);
+
+                goto egress;
+            }
+
+            /* Cache the definition for the next request on the
+               same multiknob file, unless the file's modification
+               time can't be found.
+            ------------------------------------------------------- */
+            if (file_found && strlen(mkb_file) <= MAX_MKB_FILE_LEN)
+            {
+                strcpy(mkb_knobdef_file, mkb_file);
+                mkb_knobdef_mtime = file_stat.st_mtime;
+            }
+        }
+
+        mkb_absolute_multiknob_file = mkb_knobdef.absolute_knob_function;
+
+        if (mkb_absolute_multiknob_file)
+        {
+            fprintf(stderr, "found an absolute knob file\n");
+
+            knobfunc = KNOB_END;
+
+            iss = mkb_crrdrvr(&crrknob_num, &knobfunc,
+                    &relative_delta_value);
+
+            goto egress;
+        }
+
+        /* Perform the assign operation using function code
+           KNOB_INIT.
+        --------------------------------------------------- */
+        knobfunc = KNOB_INIT;
+
+        iss = mkb_crrdrvr(&crrknob_num, &knobfunc,
+                &relative_delta_value);
+        if (!SUCCESS(iss))
+        {
+            fprintf(stderr, "return from KNOB_INIT mkb_crrdrvr = %x\n", iss);
+            status = iss;
+            goto egress;
+        }
+    }
+
+    mkb_absolute_multiknob_file = FALSE;
+
+    /* Perform the relative knob rotation specified by the
+       knob relative delta value for the devices specified
+       by the multiknob file.
+    ------------------------------------------------------ */
+    knobfunc = KNOB_ROT;
 
     iss = mkb_crrdrvr(&crrknob_num, &knobfunc,
-            &relative_delta_value, &dummy_zero, &parse_only);
+            &relative_delta_value);
     if (!SUCCESS(iss))
     {
-        fprintf(stderr, "return from parse only KNOB_INIT mkb_crrdrvr = %x\n",
-                iss);
+        fprintf(stderr, "return from KNOB_ROT mkb_crrdrvr = %x\n", iss);
         status = iss;
+        mkb_session_assigned = FALSE;
         goto egress;
     }
 
-    /* Get the multiknob file contents, stored in structure
-       instance mkbhst_data.  Store an indication of whether
-       the absolute_knob_function element of this structure
-       indicates that the specified multiknob file has the
-       "absolute" flag set.  If this "absolute" flag is set,
-       perform the  deassign operation and exit.  Otherwise,
-       other elements of this structure will be used later
-       in extracting the device names contained in the file.
-    -------------------------------------------------------- */
-    iss = mkbhst_get_knobdef(&mkbhst_data);
-    if (!SUCCESS(iss))
+    if (session && strlen(mkb_file) <= MAX_MKB_FILE_LEN)
     {
-        fprintf(stderr, "return from mkbhst_get_knobdef = %x\n", iss);
-        status = iss;
+        /* Keep the knob assigned for the next step of the
+           knob session.
+        -------------------------------------------------- */
+        mkb_session_assigned = TRUE;
+        strcpy(mkb_session_file, mkb_file);
+        mkb_session_last_step = now;
+    }
+    else
+    {
+        /* Perform the deassign operation using function code
+           KNOB_END.
+        ----------------------------------------------------- */
+        mkb_session_assigned = FALSE;
 
         knobfunc = KNOB_END;
 
         iss = mkb_crrdrvr(&crrknob_num, &knobfunc,
                 &relative_delta_value);
+        if (!SUCCESS(iss))
+        {
+            fprintf(stderr, "return from KNOB_END mkb_crrdrvr = %x\n", iss);
+            status = iss;
+            goto egress;
+        }
+    }
 
-        goto egress;
+    /* The device names, and the database list used to read back
+       their secondary values, are only formed once for each
+       definition of the multiknob file.
+    ------------------------------------------------------------ */
+    if (!mkb_devices_listed)
+    {
+        iss = mkbListDevices();
+        if (!SUCCESS(iss))
+        {
+            status = iss;
+            goto egress;
+        }
     }
 
-    mkb_absolute_multiknob_file = mkbhst_data.absolute_knob_function;
+    /* Return the number of devices in the specified multiknob
+       file.
+    ---------------------------------------------------------- */
+    *file_num_devices = mkb_num_devices;
 
-    if (mkb_absolute_multiknob_file)
+    /* Retrieve the secondary values of all the devices with one
+       call to DBlgetC and store them in the static float array
+       mkb_secn_values.
+    ------------------------------------------------------------ */
+    iss = mkbReadSecnValues();
+    if (!SUCCESS(iss))
     {
-        fprintf(stderr, "found an absolute knob file\n");
+        status = iss;
+        goto egress;
+    }
 
-        knobfunc = KNOB_END;
+egress:
 
-        iss = mkb_crrdrvr(&crrknob_num, &knobfunc,
-                &relative_delta_value);
+    return status;
+}
 
-        goto egress;
-    }
+/* ============================================================================`
 
-    /* Perform the assign operation using function code
-       KNOB_INIT.
-    --------------------------------------------------- */
-    knobfunc = KNOB_INIT;
+  Abs:  End a knob session.
+
+  Name: mkbEndSession
+
+  Args: void
+
+  Rem:  Performs the deassign operation for the multiknob file
+        left assigned by the last step of a knob session.
+
+  Side: The knob is no longer assigned.
+
+  Ret:  vmsstat_t value indicating usual error status.
+
+==============================================================================*/
+
+static vmsstat_t mkbEndSession(void)
+{
+    vmsstat_t iss;
+
+    int4u crrknob_num; /* crr knob number */
+    int4u knobfunc;    /* knob function code */
+
+    float relative_delta_value;
+
+/*---------------------------------------------------*/
+
+    mkb_session_assigned = FALSE;
+    mkb_session_file[0] = '\0';
+
+    crrknob_num = CRRKNOB_NUM;
+    knobfunc = KNOB_END;
+    relative_delta_value = 0.0;
 
     iss = mkb_crrdrvr(&crrknob_num, &knobfunc,
             &relative_delta_value);
     if (!SUCCESS(iss))
     {
-        fprintf(stderr, "return from KNOB_INIT mkb_crrdrvr = %x\n", iss);
-        status = iss;
-        goto egress;
+        fprintf(stderr, "return from session KNOB_END mkb_crrdrvr = %x\n", iss);
     }
 
-    /* Perform the relative knob rotation specified by the
-       knob relative delta value for the devices specified
-       by the multiknob file.
-    ------------------------------------------------------ */
-    knobfunc = KNOB_ROT;
+    return iss;
+}
 
-    iss = mkb_crrdrvr(&crrknob_num, &knobfunc,
-            &relative_delta_value);
-    if (!SUCCESS(iss))
+/* ============================================================================`
+
+  Abs:  End a knob session that has been idle for too long.
+
+  Name: mkbExpireSession
+
+  Args:
+        now                            The time now.
+          Use:   time
+          Type:  time_t
+          Acc:   read-only
+          Mech:  value
+
+  Rem:  Performs the deassign operation for the multiknob file left
+        assigned by a knob session if its last step was more than
+        MKB_SESSION_IDLE_EXPIRY seconds ago.  Called at the start
+        of every multiknob request, so an abandoned session is
+        released by the next one, whatever file it is for.
+
+  Side: The knob is no longer assigned if the session has expired.
+
+  Ret:  None
+
+==============================================================================*/
+
+static void mkbExpireSession(time_t now)
+{
+
+/*---------------------------------------------------*/
+
+    if (mkb_session_assigned &&
+            now - mkb_session_last_step > MKB_SESSION_IDLE_EXPIRY)
     {
-        fprintf(stderr, "return from KNOB_ROT mkb_crrdrvr = %x\n", iss);
-        status = iss;
-        goto egress;
+        mkbEndSession();
     }
 
-    /* Perform the deassign operation using function code
-       KNOB_END.
-    ----------------------------------------------------- */
-    knobfunc = KNOB_END;
+    return;
+}
 
-    iss = mkb_crrdrvr(&crrknob_num, &knobfunc,
-            &relative_delta_value);
+/* ============================================================================`
+
+  Abs:  Determine whether a knob session is assigned for a multiknob
+        file.
+
+  Name: DPSLCUTIL_MKB_INSESSION
+
+  Args:
+        mkb_file                       Multiknob file name.
+          Use:   string
+          Type:  char *
+          Acc:   read-only
+          Mech:  reference
+
+  Rem:  Returns a flag indicating whether the last step on the
+        specified multiknob file left the knob assigned in a knob
+        session.
+
+  Side: None
+
+  Ret:  True flag value if a knob session is assigned for the
+        multiknob file, false flag value otherwise.
+
+==============================================================================*/
+
+int DPSLCUTIL_MKB_INSESSION (char *mkb_file)
+{
+
+/*---------------------------------------------------*/
+
+    mkbExpireSession(time(NULL));
+
+    return (mkb_session_assigned &&
+            strcmp(mkb_session_file, mkb_file) == 0);
+}
+
+/* ============================================================================`
+
+  Abs:  End the knob session of a multiknob file.
+
+  Name: DPSLCUTIL_MKB_ENDSESSION
+
+  Args:
+        mkb_file                       Multiknob file name.
+          Use:   string
+          Type:  char *
+          Acc:   read-only
+          Mech:  reference
+
+        file_num_devices               Number of devices obtained from
+          Use:   integer pointer       the specified multiknob file.
+          Type:  int *
+          Acc:   write-only
+          Mech:  reference
+
+  Rem:  Performs the deassign operation for the multiknob file left
+        assigned in a knob session, without a further rotation, and
+        reads back the secondary values of its devices as
+        DPSLCUTIL_DO_MKB does.  Does nothing if no knob session is
+        assigned for the specified multiknob file (see
+        DPSLCUTIL_MKB_INSESSION).
+
+  Side: The knob is no longer assigned.  The device names and
+        secondary values are stored as for DPSLCUTIL_DO_MKB, and
+        must be later freed by a call to DPSLCUTIL_MKB_GETCLEANUP.
+
+  Ret:  vmsstat_t value indicating usual error status.
+
+==============================================================================*/
+
+vmsstat_t DPSLCUTIL_MKB_ENDSESSION (char *mkb_file,
+        int *file_num_devices)
+{
+    vmsstat_t iss;
+
+/*---------------------------------------------------*/
+
+    *file_num_devices = 0;
+    mkb_absolute_multiknob_file = FALSE;
+
+    if (!DPSLCUTIL_MKB_INSESSION(mkb_file))
+    {
+        return 1;
+    }
+
+    iss = mkbEndSession();
     if (!SUCCESS(iss))
     {
-        fprintf(stderr, "return from KNOB_END mkb_crrdrvr = %x\n", iss);
-        status = iss;
-        goto egress;
+        return iss;
+    }
+
+    /* The devices were listed by the steps of the session, but
+       were freed after each step if the file's definition could
+       not be cached, so they are listed again from the definition
+       got for the session.
+    ------------------------------------------------------------ */
+    if (!mkb_devices_listed)
+    {
+        iss = mkbListDevices();
+        if (!SUCCESS(iss))
+        {
+            return iss;
+        }
     }
 
-    /* Return the number of devices in the specified multiknob
-       file.
-    ---------------------------------------------------------- */
-    mkb_num_devices = mkbhst_data.ndevice_fetched;
     *file_num_devices = mkb_num_devices;
 
-    if (mkb_num_devices > 0)
+    return mkbReadSecnValues();
+}
+
+/* ============================================================================`
+
+  Abs:  List the devices of the cached multiknob file definition.
+
+  Name: mkbListDevices
+
+  Args: void
+
+  Rem:  Forms the device names of the multiknob file definition in
+        mkb_knobdef, and the database list needed to retrieve their
+        secondary values (e.g., BDES) using DBlgetC.  These are kept
+        with the definition so each later step on the same
+        multiknob file only needs the one call to DBlgetC.
+
+  Side: Replaces the arrays in static pointers mkb_device_names and
+        mkb_secn_values, and the database list mkb_db_list_ps.  Sets
+        mkb_num_devices and mkb_devices_listed.
+
+  Ret:  vmsstat_t value indicating usual error status.
+
+==============================================================================*/
+
+static vmsstat_t mkbListDevices(void)
+{
+    vmsstat_t iss;
+
+    int i;
+    int j;
+    int device_name_index; /* Current index into mkb_device_names */
+    int num_leading_blanks;  /* Number of leading blanks in front of unit */
+    int num_unit_digits;     /* Number of digits in unit */
+
+    int4u prim;
+    int4u micr;
+    int4u unit;
+    int4u secn;
+
+    char cur_device_name[MAX_DEVICE_STRING_LEN + 1];
+    char unit_buf[MAX_UNIT_NUM_LEN + 1];   /* Unit number buffer */
+
+/*---------------------------------------------------*/
+
+    mkbFreeDevices();
+
+    mkb_num_devices = mkb_knobdef.ndevice_fetched;
+
+    if (mkb_num_devices <= 0)
     {
-        /* The dynamically allocated arrays mkb_device_names and
-           mkb_secn_values must be freed after they have been
-           returned to the Java layer.
-        -------------------------------------------------------- */
-        mkb_device_names = (char *) malloc((mkb_num_devices *
-                MAX_DEVICE_STRING_LEN) + 1);
-
-        mkb_secn_values = (float *) malloc((mkb_num_devices) *
-                sizeof(float));
-
-        /* Form the mkb_device_names array of strings.  Each device
-           name is formed and stored into the next location of
-           this string.  Each device name occupies
-           MAX_DEVICE_STRING_LEN characters.  The device name
-           consists of the primary, micro, unit, and secondary
-           fields, separated by colons.  If a device name
-           requires less than MAX_DEVICE_STRING_LEN characters
-           (i.e., the unit number is less than the maximum of
-           5 characters), the device name is right padded with
-           null characters.
-        ----------------------------------------------------------- */
-        for (i = 0; i < mkb_num_devices; i++)
-        {
-            device_name_index = 0;
+        mkb_devices_listed = TRUE;
+        return 1;
+    }
 
-            memcpy(&cur_device_name[device_name_index],
-                    &(mkbhst_data.dev_list[i][0]), PRIM_LEN_NAME);
-            device_name_index += PRIM_LEN_NAME;
+    /* The dynamically allocated arrays mkb_device_names and
+       mkb_secn_values are kept with the multiknob file
+       definition, and freed when it is replaced.
+    -------------------------------------------------------- */
+    mkb_device_names = (char *) malloc((mkb_num_devices *
+            MAX_DEVICE_STRING_LEN) + 1);
 
-            strncpy(cur_device_name + device_name_index, ":", 1);
-            device_name_index++;
+    mkb_secn_values = (float *) malloc((mkb_num_devices) *
+            sizeof(float));
 
-            memcpy(&cur_device_name[device_name_index],
-                    &(mkbhst_data.dev_list[i][1]), MICR_LEN_NAME);
-            device_name_index += MICR_LEN_NAME;
+    if (mkb_device_names == NULL || mkb_secn_values == NULL)
+    {
+        fprintf(stderr, "unable to allocate multiknob device arrays\n");
+        mkbFreeDevices();
+        return MEMORY_ALLOCATE_FAIL;
+    }
 
-            strncpy(cur_device_name + device_name_index, ":", 1);
-            device_name_index++;
+    /* Form the mkb_device_names array of strings.  Each device
+       name is formed and stored into the next location of
+       this string.  Each device name occupies
+       MAX_DEVICE_STRING_LEN characters.  The device name
+       consists of the primary, micro, unit, and secondary
+       fields, separated by colons.  If a device name
+       requires less than MAX_DEVICE_STRING_LEN characters
+       (i.e., the unit number is less than the maximum of
+       5 characters), the device name is right padded with
+       null characters.
+    ----------------------------------------------------------- */
+    for (i = 0; i < mkb_num_devices; i++)
+    {
+        device_name_index = 0;
 
-            sprintf(unit_buf, "%5d", mkbhst_data.dev_list[i][2]);
-            unit_buf[MAX_UNIT_NUM_LEN] = '\0';
+        memcpy(&cur_device_name[device_name_index],
+                &(mkb_knobdef.dev_list[i][0]), PRIM_LEN_NAME);
+        device_name_index += PRIM_LEN_NAME;
 
-            num_leading_blanks = strspn(unit_buf, " ");
-            num_unit_digits = MAX_UNIT_NUM_LEN - num_leading_blanks;
+        strncpy(cur_device_name + device_name_index, ":", 1);
+        device_name_index++;
 
-            strncpy(cur_device_name + device_name_index,
-                    unit_buf + num_leading_blanks, num_unit_digits);
-            device_name_index += num_unit_digits;
+        memcpy(&cur_device_name[device_name_index],
+                &(mkb_knobdef.dev_list[i][1]), MICR_LEN_NAME);
+        device_name_index += MICR_LEN_NAME;
 
-            strncpy(cur_device_name + device_name_index, ":", 1);
-            device_name_index++;
+        strncpy(cur_device_name + device_name_index, ":", 1);
+        device_name_index++;
 
-            memcpy(&cur_device_name[device_name_index],
-                    &(mkbhst_data.dev_list[i][3]), SECN_LEN_NAME);
-            device_name_index += SECN_LEN_NAME;
+        sprintf(unit_buf, "%5d", mkb_knobdef.dev_list[i][2]);
+        unit_buf[MAX_UNIT_NUM_LEN] = '\0';
 
-            for (j = 0; j < num_leading_blanks; j++)
-            {
-                cur_device_name[device_name_index] = '\0';
-                device_name_index++;
-            }
+        num_leading_blanks = strspn(unit_buf, " ");
+        num_unit_digits = MAX_UNIT_NUM_LEN - num_leading_blanks;
 
-            cur_device_name[MAX_DEVICE_STRING_LEN] = '\0';
+        strncpy(cur_device_name + device_name_index,
+                unit_buf + num_leading_blanks, num_unit_digits);
+        device_name_index += num_unit_digits;
 
-#ifdef DEBUG
-            fprintf(stderr, "cur_device_name = %s\n", cur_device_name);
-#endif
+        strncpy(cur_device_name + device_name_index, ":", 1);
+        device_name_index++;
 
-            memcpy(mkb_device_names + (i * MAX_DEVICE_STRING_LEN),
-                    cur_device_name, MAX_DEVICE_STRING_LEN);
+        memcpy(&cur_device_name[device_name_index],
+                &(mkb_knobdef.dev_list[i][3]), SECN_LEN_NAME);
+        device_name_index += SECN_LEN_NAME;
+
+        for (j = 0; j < num_leading_blanks; j++)
+        {
+            cur_device_name[device_name_index] = '\0';
+            device_name_index++;
         }
 
-        *(mkb_device_names + (mkb_num_devices * MAX_DEVICE_STRING_LEN) + 1) =
-                '\0';
+        cur_device_name[MAX_DEVICE_STRING_LEN] = '\0';
 
 #ifdef DEBUG
-        fprintf(stderr, "mkb_device_names = %s\n", mkb_device_names);
+        fprintf(stderr, "cur_device_name = %s\n", cur_device_name);
 #endif
+
+        memcpy(mkb_device_names + (i * MAX_DEVICE_STRING_LEN),
+                cur_device_name, MAX_DEVICE_STRING_LEN);
     }
 
+    *(mkb_device_names + (mkb_num_devices * MAX_DEVICE_STRING_LEN)) =
+            '\0';
+
+#ifdef DEBUG
+    fprintf(stderr, "mkb_device_names = %s\n", mkb_device_names);
+#endif
 
     /* Form a database list of device names needed to retrieve the
-       specified secondary (e.g., BDES) using DBlistC.  Then call
-       DBlistC to retrieve these secondary values and store them
-       in the static float array mkb_secn_values.
+       specified secondary (e.g., BDES) using DBlgetC.
     -------------------------------------------------------------- */
-    DBCLEAR(db_list_ps);
-    DBCLEAR(db_float_data_ps);
-
     for (i = 0; i < mkb_num_devices; i++)
     {
-        memcpy(&prim, &(mkbhst_data.dev_list[i][0]),
+        memcpy(&prim, &(mkb_knobdef.dev_list[i][0]),
                 PRIM_LEN_NAME);
 
-        memcpy(&micr, &(mkbhst_data.dev_list[i][1]),
+        memcpy(&micr, &(mkb_knobdef.dev_list[i][1]),
                 MICR_LEN_NAME);
 
-        unit = mkbhst_data.dev_list[i][2];
+        unit = mkb_knobdef.dev_list[i][2];
 
-        memcpy(&secn, &(mkbhst_data.dev_list[i][3]),
+        memcpy(&secn, &(mkb_knobdef.dev_list[i][3]),
                 SECN_LEN_NAME);
 
-        iss = DBlistC((void *) &db_list_ps, prim, micr, unit,
+        iss = DBlistC((void *) &mkb_db_list_ps, prim, micr, unit,
                 secn, NULL);
         if (!SUCCESS(iss))
         {
             fprintf(stderr, "return from call %d to DBlistC = %x\n", i, iss);
-            status = iss;
-            goto egress;
+            mkbFreeDevices();
+            return iss;
         }
     }
 
-    if (mkb_num_devices > 0)
+    mkb_devices_listed = TRUE;
+
+    return 1;
+}
+
+/* ============================================================================`
+
+  Abs:  Read back the secondary values of the listed multiknob
+        devices.
+
+  Name: mkbReadSecnValues
+
+  Args: void
+
+  Rem:  Retrieves the secondary values of all the devices listed by
+        mkbListDevices with one call to DBlgetC.
+
+  Side: Stores the values in the static float array mkb_secn_values.
+
+  Ret:  vmsstat_t value indicating usual error status.
+
+==============================================================================*/
+
+static vmsstat_t mkbReadSecnValues(void)
+{
+    vmsstat_t iss;
+
+#ifdef DEBUG
+    int i;
+#endif
+
+    DBLIST(db_float_data_ps, float); /* Database float data */
+
+/*---------------------------------------------------*/
+
+    if (mkb_num_devices <= 0)
+    {
+        return 1;
+    }
+
+    DBCLEAR(db_float_data_ps);
+
+    iss = DBlgetC((void *) &db_float_data_ps,
+            (void *) &mkb_db_list_ps);
+    if (!SUCCESS(iss))
     {
-        iss = DBlgetC((void *) &db_float_data_ps,
-                (void *) &db_list_ps);
-        if (!SUCCESS(iss))
-        {
-            fprintf(stderr, "return from DBlgetC = %x\n", iss);
-            status = iss;
-            goto egress;
-        }
+        fprintf(stderr, "return from DBlgetC = %x\n", iss);
+        DBFREE(db_float_data_ps);
+        return iss;
+    }
 
-        for (i = 0; i < mkb_num_devices; i++)
-        {
-            *(mkb_secn_values + i) = db_float_data_ps->dat[i];
+    memcpy(mkb_secn_values, db_float_data_ps->dat,
+            mkb_num_devices * sizeof(float));
 
 #ifdef DEBUG
-            fprintf(stderr, "db_float_data_ps->dat[%d] = %f\n",
-                i, db_float_data_ps->dat[i]);
+    for (i = 0; i < mkb_num_devices; i++)
+    {
+        fprintf(stderr, "db_float_data_ps->dat[%d] = %f\n",
+            i, db_float_data_ps->dat[i]);
+    }
 #endif
-        }
+
+    DBFREE(db_float_data_ps);
+
+    return 1;
+}
+
+/* ============================================================================`
+
+  Abs:  Free the devices listed for a multiknob file definition.
+
+  Name: mkbFreeDevices
+
+  Args: void
+
+  Rem:  Frees the device names, secondary values, and database list
+        formed by mkbListDevices.
+
+  Side: The devices are no longer listed.
+
+  Ret:  None
+
+==============================================================================*/
+
+static void mkbFreeDevices(void)
+{
+
+/*---------------------------------------------------*/
+
+    mkb_devices_listed = FALSE;
+    mkb_num_devices = 0;
+
+    if (mkb_device_names != NULL)
+    {
+        free(mkb_device_names);
+        mkb_device_names = NULL;
     }
 
-egress:
+    if (mkb_secn_values != NULL)
+    {
+        free(mkb_secn_values);
+        mkb_secn_values = NULL;
+    }
 
-    return status;
+    DBFREE(mkb_db_list_ps);
+    DBCLEAR(mkb_db_list_ps);
+
+    return;
 }
 
 /* ============================================================================`
@@ -717,6 +1195,48 @@ void DPSLCUTIL_MKB_GETSECNVALUES(float *values)
     return;
 }
 
+/* ============================================================================`
+
+  Abs:  Get the multiknob device names and secondary values.
+
+  Name: DPSLCUTIL_MKB_GETRESULTS
+
+  Args:
+        device_names                   Set to the multiknob device
+          Use:   string pointer        names stored by a previous call
+          Type:  char **               to DPSLCUTIL_DO_MKB.
+          Acc:   write-only
+          Mech:  reference
+
+        values                         Set to the secondary values
+          Use:   float array pointer   stored by a previous call to
+          Type:  float **              DPSLCUTIL_DO_MKB.
+          Acc:   write-only
+          Mech:  reference
+
+  Rem:  Gets the device names and secondary values stored by a
+        previous call to DPSLCUTIL_DO_MKB, without copying them.
+        They are only valid until the call to
+        DPSLCUTIL_MKB_GETCLEANUP, or the next call to
+        DPSLCUTIL_DO_MKB.
+
+  Side: None
+
+  Ret:  Value in static variable mkb_num_devices.
+
+==============================================================================*/
+
+int DPSLCUTIL_MKB_GETRESULTS(char **device_names, float **values)
+{
+
+/*---------------------------------------------------*/
+
+    *device_names = mkb_device_names;
+    *values = mkb_secn_values;
+
+    return mkb_num_devices;
+}
+
 /* ============================================================================`
 
   Abs:  Cleanup for previous call to DPSLCUTIL_DO_MKB.
@@ -730,7 +1250,9 @@ void DPSLCUTIL_MKB_GETSECNVALUES(float *values)
         made after the call to DPSLCUTIL_DO_MKB and subsequent calls to
         DPSLCUTIL_MKB_GETNAMES and DPSLCUTIL_MKB_GETSECNVALUES, which
         may be used to return information in the dynamic memory areas
-        mkb_device_names and mkb_secn_values.
+        mkb_device_names and mkb_secn_values.  The memory is kept
+        while the multiknob file definition is cached, for the next
+        request on the same file, and freed when it is replaced.
 
   Side: None
 
@@ -743,16 +1265,9 @@ void DPSLCUTIL_MKB_GETCLEANUP()
 
 /*---------------------------------------------------*/
 
-    if (mkb_device_names != NULL)
+    if (mkb_knobdef_file[0] == '\0')
     {
-        free(mkb_device_names);
-        mkb_device_names = NULL;
-    }
-
-    if (mkb_secn_values != NULL)
-    {
-        free(mkb_secn_values);
-        mkb_secn_values = NULL;
+        mkbFreeDevices();
     }
 
     return;
@@ -893,6 +1408,101 @@ egress:
     return iss;
 }
 
+/* ============================================================================`
+
+  Abs:  Get the status codes for a list of devices on the
+        specified beam code.
+
+  Name: DPSLCUTIL_TRIG_GETSTATUSES
+
+  Args:
+        count                        The number of devices.
+          Use:   integer
+          Type:  int
+          Acc:   read-only
+          Mech:  value
+
+        slcnames                     The specified devices, each
+          Use:   string array        identified by a primary:micro:unit
+          Type:  char **             string.
+          Acc:   read-only
+          Mech:  reference
+
+        beam                         An integer containing the specified
+          Use:   integer             beam code number.
+          Type:  int
+          Acc:   read-only
+          Mech:  value
+
+        trig_statuses                The output status code of each
+          Use:   short array         device (0 => deactivated,
+          Type:  short *             1 => activated).  Set to 0 for a
+          Acc:   write-only          device whose status can't be
+          Mech:  reference           obtained.
+
+        iss_statuses                 The vmsstat_t status of the
+          Use:   vmsstat_t array     request for each device.
+          Type:  vmsstat_t *
+          Acc:   write-only
+          Mech:  reference
+
+  Rem:  Obtains the status code of every device in the list by
+        calling DPSLCUTIL_TRIG_GETSTATUS for each device in turn, so
+        there is still one backend request per device.  A device
+        whose status can't be obtained doesn't stop the others
+        being read.  A device name that isn't a
+        primary:micro:unit string is refused with status
+        BAD_DEVICE_NAME.
+
+  Side: none
+
+  Ret:  The number of devices whose status was obtained.
+
+==============================================================================*/
+
+int DPSLCUTIL_TRIG_GETSTATUSES (int count,
+        char **slcnames,
+        int beam,
+        short *trig_statuses,
+        vmsstat_t *iss_statuses)
+{
+    int i;
+    int num_obtained;
+
+/*---------------------------------------------------*/
+
+    num_obtained = 0;
+
+    for (i = 0; i < count; i++)
+    {
+        trig_statuses[i] = 0;
+
+        /* The primary must fit and be followed by a micro and
+           unit, for parseDeviceName.
+        ------------------------------------------------------ */
+        if (strcspn(slcnames[i], ".:;") > PRIM_LEN_NAME ||
+                strlen(slcnames[i]) <= PRIM_LEN_NAME + MICR_LEN_NAME + 2)
+        {
+            fprintf(stderr, "bad trigger device name = %s\n", slcnames[i]);
+            iss_statuses[i] = BAD_DEVICE_NAME;
+            continue;
+        }
+
+        iss_statuses[i] = DPSLCUTIL_TRIG_GETSTATUS(slcnames[i], beam,
+                &trig_statuses[i]);
+        if (SUCCESS(iss_statuses[i]))
+        {
+            num_obtained++;
+        }
+        else
+        {
+            trig_statuses[i] = 0;
+        }
+    }
+
+    return num_obtained;
+}
+
 /* ============================================================================`
 
   Abs:  Determine whether Aida trigger operations are permitted
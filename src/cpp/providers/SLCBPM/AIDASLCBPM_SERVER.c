@@ -6,13 +6,34 @@
 #include "aida_pva.h"
 #include "AIDASLCBPM_SERVER.h"
 
-static int checkArguments(JNIEnv* env, int bpmd, int navg, int cnfnum, int sortOrder, int cnftype);
-static int acquireBpmData(JNIEnv* env, int* rows, int bpmd, int n, int cnftype, int cnfnum, int sortOrder);
+static int checkArguments(JNIEnv* env, const int* bpmds, int bpmdCount, int navg, int cnfnum, int sortOrder, int cnftype,
+		float maxAge);
+static Table getBpmOrbitsTable(JNIEnv* env, const int* bpmds, int count, bool withBpmd, int n, int cnftype, int cnfnum,
+		int sortOrder, float maxAge);
+static BpmSnapshot* findBpmSnapshot(int bpmd, int n, int cnftype, int cnfnum, double now);
+static void releaseBpmSnapshot(BpmSnapshot* snapshot);
+static int readBpmOrbits(JNIEnv* env, BpmOrbit** orbits, const int* bpmds, int count, int n, int cnftype, int cnfnum);
+static int readBpmOrbit(JNIEnv* env, BpmOrbit* orbit, int bpmd, int n, int cnftype, int cnfnum);
+static Table bpmOrbitsTable(JNIEnv* env, BpmOrbit** orbits, int count, int sortOrder, bool withAge, bool withBpmd);
+static const int* bpmZOrder(JNIEnv* env, BpmOrbit* orbit);
+static int compareZ(const void* a, const void* b);
+static int startAcquireBpmData(JNIEnv* env);
+static int acquireBpmData(JNIEnv* env, int* rows, int bpmd, int n, int cnftype, int cnfnum);
 static int getBpmData(JNIEnv* env,
-		char namesData[MAX_DGRP_BPMS][NAME_SIZE], float* xData, float* yData, float* tmitData, float* zData,
-		unsigned long* hstasData, unsigned long* statsData);
+		char namesData[][NAME_SIZE], float* xData, float* yData, float* tmitData, float* zData,
+		int4u* hstasData, int4u* statsData);
 static int endAcquireBpmData(JNIEnv* env);
 
+// Latest orbit snapshots for requests that give a MAXAGE
+static BpmSnapshot bpmSnapshots[MAX_BPM_SNAPSHOTS];
+
+// Z order of the BPMs of recently sorted measurement definitions
+static BpmZOrder bpmZOrders[MAX_BPM_Z_ORDERS];
+static unsigned long bpmZOrdersClock = 0;
+
+// The z positions being sorted by compareZ()
+static const float* sortingZData;
+
 // API Stubs
 VERSION("1.0.0")
 REQUEST_STUB_BOOLEAN
@@ -58,6 +79,13 @@ void aidaServiceInit(JNIEnv* env)
  * end acquisition
  * Return data
  *
+ * If a MAXAGE is given then the table is instead served from the latest orbit acquired for the same
+ * measurement definition, if it is no older than MAXAGE seconds, with an extra column giving its age.
+ *
+ * If a list of BPMDS is given instead of a BPMD then the orbits of all the measurement definitions are
+ * acquired back to back in one acquisition session, and returned in one table with extra columns giving
+ * the age of each orbit and the measurement definition of each row.
+ *
  * @param env to be used to throw exceptions using aidaThrow() and aidaThrowNonOsException()
  * @param uri the uri
  * @param arguments the arguments
@@ -68,18 +96,41 @@ Table aidaRequestTable(JNIEnv* env, const char* uri, Arguments arguments)
 	TRACK_ALLOCATED_MEMORY
 
 	// Get arguments
-	int bpmd, navg = NAVG, cnfnum = BPMD_ROGUE, sortOrder = SORTORDER_DISPLAY, cnftype = CNFTYPE_NONE;
+	int bpmd = BPMD_ROGUE, navg = NAVG, cnfnum = BPMD_ROGUE, sortOrder = SORTORDER_DISPLAY, cnftype = CNFTYPE_NONE;
+	int* bpmdList = NULL;
+	unsigned int bpmdListCount = 0;
+	float maxAge = 0.0f;
 	char* cfnTypeString = NULL;
 
-	if (ascanf(env, &arguments, "%d %od %od %od %os",
+	if (ascanf(env, &arguments, "%od %oda %od %od %od %os %of",
 			"bpmd", &bpmd,
+			"bpmds", &bpmdList, &bpmdListCount,
 			"n", &navg,
 			"cnfnum", &cnfnum,
 			"sortOrder", &sortOrder,
-			"cnftype", &cfnTypeString
+			"cnftype", &cfnTypeString,
+			"maxAge", &maxAge
 	)) {
 		RETURN_NULL_TABLE
 	}
+
+	// Gather the measurement definitions from either BPMD or BPMDS
+	int bpmds[MAX_BPMDS], bpmdCount = 1;
+	bool withBpmd = bpmdList != NULL;
+	bpmds[0] = bpmd;
+	if (withBpmd) {
+		if (bpmd != BPMD_ROGUE || bpmdListCount > MAX_BPMDS) {
+			free(bpmdList);
+			free(cfnTypeString);
+			aidaThrowNonOsException(env, UNABLE_TO_GET_DATA_EXCEPTION,
+					bpmd != BPMD_ROGUE ? "Give either a BPMD or a BPMDS argument, not both"
+									   : "Too many measurement definitions in the BPMDS argument");
+			RETURN_NULL_TABLE
+		}
+		bpmdCount = (int)bpmdListCount;
+		memcpy(bpmds, bpmdList, bpmdCount * sizeof(int));
+		free(bpmdList);
+	}
 	TRACK_MEMORY(cfnTypeString)
 
 	// If cfnType was set then set cnftype variable appropriately
@@ -115,78 +166,451 @@ Table aidaRequestTable(JNIEnv* env, const char* uri, Arguments arguments)
 	}
 
 	// Check parameters
-	if (checkArguments(env, bpmd, navg, cnfnum, sortOrder, cnftype)) {
+	if (checkArguments(env, bpmds, bpmdCount, navg, cnfnum, sortOrder, cnftype, maxAge)) {
 		RETURN_NULL_TABLE
 	}
 
+	// Acquire BPM Data, make and output table
+	return getBpmOrbitsTable(env, bpmds, bpmdCount, withBpmd, navg, cnftype, cnfnum, sortOrder, maxAge);
+}
+
+/**
+ * Get a table of the orbits of the given measurement definitions.  All the orbits that
+ * need acquiring are acquired back to back in one acquisition session.
+ *
+ * If a maximum age is given then the latest orbit for each measurement definition is used, and a new orbit
+ * is only acquired if there isn't one, or it is older than the maximum age.  So any number of displays
+ * watching the same measurement definition, in either sort order, share one acquisition every maxAge seconds.
+ * Each new orbit is acquired into its snapshot's other buffer so the latest orbit is
+ * kept if the acquisition fails.  Snapshots that are not requested for
+ * BPM_SNAPSHOT_IDLE_EXPIRY seconds are released.
+ *
+ * @param env to be used to throw exceptions using aidaThrow() and aidaThrowNonOsException()
+ * @param bpmds the measurement definitions, all different
+ * @param count the number of measurement definitions, at most MAX_BPMDS
+ * @param withBpmd true to add columns with the age and measurement definition of each orbit
+ * @param n the number of readings to average or turns
+ * @param cnftype the config type
+ * @param cnfnum the config number
+ * @param sortOrder the sort order
+ * @param maxAge the maximum age, in seconds, of an orbit that can be returned, or 0 to always acquire new orbits
+ * @return the table
+ */
+static Table getBpmOrbitsTable(JNIEnv* env, const int* bpmds, int count, bool withBpmd, int n, int cnftype, int cnfnum,
+		int sortOrder, float maxAge)
+{
+	BpmOrbit newOrbits[MAX_BPMDS];          // Orbits acquired for this request only, when there is no maxAge
+	BpmOrbit* orbits[MAX_BPMDS];            // The orbit returned for each measurement definition
+	BpmOrbit* acquiring[MAX_BPMDS];         // The orbits to acquire
+	BpmSnapshot* refreshing[MAX_BPMDS];     // The snapshot of each orbit to acquire, if any
+	int acquiringBpmds[MAX_BPMDS], acquiringCount = 0;
+	double now = aidaTimeNow();
+	memset(newOrbits, 0, sizeof(newOrbits));
+
+	for (int i = 0; i < count; i++) {
+		BpmSnapshot* snapshot = NULL;
+		BpmOrbit* orbit = &newOrbits[i];
+		if (maxAge > 0.0f) {
+			snapshot = findBpmSnapshot(bpmds[i], n, cnftype, cnfnum, now);
+			snapshot->lastRequested = now;
+			orbits[i] = &snapshot->orbits[snapshot->current];
+			if (orbits[i]->rows && now - orbits[i]->acquired <= maxAge) {
+				continue;
+			}
+			orbit = &snapshot->orbits[!snapshot->current];
+		}
+
+		orbits[i] = acquiring[acquiringCount] = orbit;
+		refreshing[acquiringCount] = snapshot;
+		acquiringBpmds[acquiringCount++] = bpmds[i];
+	}
+
 	// Acquire BPM Data
+	Table table;
+	if (readBpmOrbits(env, acquiring, acquiringBpmds, acquiringCount, n, cnftype, cnfnum)) {
+		table.columnCount = 0;
+	} else {
+		// New orbits are now the latest
+		for (int i = 0; i < acquiringCount; i++) {
+			if (refreshing[i]) {
+				refreshing[i]->current = !refreshing[i]->current;
+			}
+		}
+
+		// Make and output table
+		table = bpmOrbitsTable(env, orbits, count, sortOrder, maxAge > 0.0f, withBpmd);
+	}
+
+	for (int i = 0; i < count; i++) {
+		free(newOrbits[i].xData);
+	}
+	return table;
+}
+
+/**
+ * Find the snapshot for the given measurement definition, releasing any idle snapshots on the way.
+ * If there isn't one then a free snapshot is taken for it, or the least recently requested one if none are free.
+ * As snapshots found for a request are marked as requested, and there are no more measurement
+ * definitions in a request than snapshots, one request never takes another's snapshot
+ *
+ * @param bpmd the measurement definition
+ * @param n the number of readings to average or turns
+ * @param cnftype the config type
+ * @param cnfnum the config number
+ * @param now the time now, in seconds
+ * @return the snapshot
+ */
+static BpmSnapshot* findBpmSnapshot(int bpmd, int n, int cnftype, int cnfnum, double now)
+{
+	BpmSnapshot* found = NULL, * freeSnapshot = NULL, * oldest = NULL;
+
+	for (int i = 0; i < MAX_BPM_SNAPSHOTS; i++) {
+		BpmSnapshot* snapshot = &bpmSnapshots[i];
+		if (snapshot->bpmd != BPMD_ROGUE && now - snapshot->lastRequested > BPM_SNAPSHOT_IDLE_EXPIRY) {
+			releaseBpmSnapshot(snapshot);
+		}
+
+		if (snapshot->bpmd == BPMD_ROGUE) {
+			if (!freeSnapshot) {
+				freeSnapshot = snapshot;
+			}
+		} else if (snapshot->bpmd == bpmd && snapshot->n == n && snapshot->cnftype == cnftype
+				&& snapshot->cnfnum == cnfnum) {
+			found = snapshot;
+		} else if (!oldest || snapshot->lastRequested < oldest->lastRequested) {
+			oldest = snapshot;
+		}
+	}
+
+	if (found) {
+		return found;
+	}
+
+	if (!freeSnapshot) {
+		releaseBpmSnapshot(oldest);
+		freeSnapshot = oldest;
+	}
+	freeSnapshot->bpmd = bpmd;
+	freeSnapshot->n = n;
+	freeSnapshot->cnftype = cnftype;
+	freeSnapshot->cnfnum = cnfnum;
+	return freeSnapshot;
+}
+
+/**
+ * Release the given snapshot, freeing its orbits
+ *
+ * @param snapshot the snapshot
+ */
+static void releaseBpmSnapshot(BpmSnapshot* snapshot)
+{
+	free(snapshot->orbits[0].xData);
+	free(snapshot->orbits[1].xData);
+	memset(snapshot, 0, sizeof(BpmSnapshot));
+	snapshot->bpmd = BPMD_ROGUE;
+}
+
+/**
+ * Acquire the orbits of the given measurement definitions back to back in one acquisition session,
+ * rather than one session each, into the given orbits.
+ * The acquisition is always ended, and on failure the orbits may be left with no rows
+ *
+ * @param env to be used to throw exceptions using aidaThrow() and aidaThrowNonOsException()
+ * @param orbits the orbits to acquire into
+ * @param bpmds the measurement definition of each orbit
+ * @param count the number of orbits to acquire
+ * @param n the number of readings to average or turns
+ * @param cnftype the config type
+ * @param cnfnum the config number
+ * @return EXIT_SUCCESS if all goes well
+ */
+static int readBpmOrbits(JNIEnv* env, BpmOrbit** orbits, const int* bpmds, int count, int n, int cnftype, int cnfnum)
+{
+	if (!count) {
+		return EXIT_SUCCESS;
+	}
+
+	// Initialise acquisition
+	if (startAcquireBpmData(env)) {
+		return EXIT_FAILURE;
+	}
+
+	for (int i = 0; i < count; i++) {
+		if (readBpmOrbit(env, orbits[i], bpmds[i], n, cnftype, cnfnum)) {
+			return EXIT_FAILURE;
+		}
+	}
+
+	endAcquireBpmData(env);
+	ON_EXCEPTION_RETURN_(EXIT_FAILURE)
+	return EXIT_SUCCESS;
+}
+
+/**
+ * Acquire a BPM orbit, in display order, into the given orbit, reusing its data block if it is big enough.
+ * The acquisition session must have been started, and it is ended if the orbit can't be acquired,
+ * in which case the orbit is left with no rows
+ *
+ * @param env to be used to throw exceptions using aidaThrow() and aidaThrowNonOsException()
+ * @param orbit the orbit to acquire into
+ * @param bpmd the measurement definition
+ * @param n the number of readings to average or turns
+ * @param cnftype the config type
+ * @param cnfnum the config number
+ * @return EXIT_SUCCESS if all goes well
+ */
+static int readBpmOrbit(JNIEnv* env, BpmOrbit* orbit, int bpmd, int n, int cnftype, int cnfnum)
+{
 	int rows;
-	if (acquireBpmData(env, &rows, bpmd, navg, cnftype, cnfnum, sortOrder)) {
-		RETURN_NULL_TABLE
+	orbit->rows = 0;
+
+	// Acquire BPM Data
+	if (acquireBpmData(env, &rows, bpmd, n, cnftype, cnfnum)) {
+		return EXIT_FAILURE;
 	}
 
 	// No rows
 	if (!rows) {
+		endAcquireBpmData(env);
 		aidaThrowNonOsException(env, UNABLE_TO_GET_DATA_EXCEPTION, "No rows were retrieved for your query");
-		RETURN_NULL_TABLE
+		return EXIT_FAILURE;
 	}
 
 	if (rows > MAX_DGRP_BPMS) {
+		endAcquireBpmData(env);
 		aidaThrowNonOsException(env, UNABLE_TO_GET_DATA_EXCEPTION, "Too many rows returned by this query");
-		RETURN_NULL_TABLE
+		return EXIT_FAILURE;
 	}
 
-	// To hold data
-	char namesData[rows + 1][NAME_SIZE];
-	float xData[rows + 1], yData[rows + 1], tmitData[rows + 1], zData[rows + 1];
-	unsigned long hstasData[rows + 1], statsData[rows + 1];
+	// To hold data.  Allocated as one block on the heap, rather than on the stack, as there can be many rows.
+	if (rows > orbit->capacity) {
+		free(orbit->xData);
+		orbit->capacity = 0;
+		orbit->xData = ALLOCATE_MEMORY(env, rows * (4 * sizeof(float) + 2 * sizeof(int4u) + NAME_SIZE), "BPM data");
+		if (!orbit->xData) {
+			endAcquireBpmData(env);
+			return EXIT_FAILURE;
+		}
+		orbit->capacity = rows;
+	}
+
+	// The floating point vectors come first, and are contiguous, so they can be converted in one go
+	orbit->yData = orbit->xData + rows;
+	orbit->tmitData = orbit->yData + rows;
+	orbit->zData = orbit->tmitData + rows;
+	orbit->hstasData = (int4u*)(orbit->zData + rows);
+	orbit->statsData = orbit->hstasData + rows;
+	orbit->namesData = (char (*)[NAME_SIZE])(orbit->statsData + rows);
 
 	// Get BPM data
-	if (getBpmData(env, namesData, xData, yData, tmitData, zData, hstasData, statsData)) {
+	if (getBpmData(env, orbit->namesData, orbit->xData, orbit->yData, orbit->tmitData, orbit->zData,
+			orbit->hstasData, orbit->statsData)) {
+		return EXIT_FAILURE;
+	}
+
+	// Convert x, y, tmit, and z to ieee format
+	CONVERT_FROM_VMS_FLOAT(orbit->xData, (int2u)(4 * rows))
+
+	orbit->bpmd = bpmd;
+	orbit->rows = rows;
+	orbit->acquired = aidaTimeNow();
+	return EXIT_SUCCESS;
+}
+
+/**
+ * Make a table from the given orbits in the given sort order, one after the other.
+ * The columns of each orbit are gathered into table order and appended to the table in one go
+ *
+ * @param env to be used to throw exceptions using aidaThrow() and aidaThrowNonOsException()
+ * @param orbits the orbits
+ * @param count the number of orbits
+ * @param sortOrder the sort order
+ * @param withAge true to add a column with the age of each orbit
+ * @param withBpmd true to add columns with the age and the measurement definition of each orbit
+ * @return the table
+ */
+static Table bpmOrbitsTable(JNIEnv* env, BpmOrbit** orbits, int count, int sortOrder, bool withAge, bool withBpmd)
+{
+	// The gathered columns are reused for each orbit so make them big enough for the biggest
+	int maxRows = 0;
+	for (int i = 0; i < count; i++) {
+		if (orbits[i]->rows > maxRows) {
+			maxRows = orbits[i]->rows;
+		}
+	}
+
+	// One block for the gathered columns: name pointers, x, y, tmit, z, age, hsta, stat, bpmd,
+	// and the null terminated names
+	char** names = ALLOCATE_MEMORY(env,
+			maxRows * (sizeof(char*) + 5 * sizeof(float) + 3 * sizeof(int4u) + NAME_SIZE + 1), "BPM table data");
+	if (!names) {
 		RETURN_NULL_TABLE
 	}
+	float* xData = (float*)(names + maxRows), * yData = xData + maxRows, * tmitData = yData + maxRows,
+			* zData = tmitData + maxRows, * ageData = zData + maxRows;
+	int4u* hstasData = (int4u*)(ageData + maxRows), * statsData = hstasData + maxRows, * bpmdData = statsData + maxRows;
+	char* nameData = (char*)(bpmdData + maxRows);
+
+	Type types[] = { AIDA_STRING_TYPE, AIDA_FLOAT_TYPE, AIDA_FLOAT_TYPE, AIDA_FLOAT_TYPE, AIDA_FLOAT_TYPE,
+					 AIDA_INTEGER_TYPE, AIDA_INTEGER_TYPE, AIDA_FLOAT_TYPE, AIDA_INTEGER_TYPE };
+	void* columns[] = { names, xData, yData, tmitData, zData, hstasData, statsData, ageData, bpmdData };
+	Table table = tableCreateStreaming(env, withBpmd ? 9 : withAge ? 8 : 7, types);
+
+	for (int i = 0; i < count && table.columnCount; i++) {
+		BpmOrbit* orbit = orbits[i];
+		int rows = orbit->rows;
+		float age = (float)(aidaTimeNow() - orbit->acquired);
+
+		const int* order = NULL;
+		if (sortOrder == SORTORDER_Z && !(order = bpmZOrder(env, orbit))) {
+			releaseTable(table);
+			table.columnCount = 0;
+			break;
+		}
 
-	// Make and output table
-	Table table = tableCreate(env, rows, 7);
-	ON_EXCEPTION_RETURN_(table)
-	tableAddFixedWidthStringColumn(env, &table, (char*)namesData, NAME_SIZE);
-	ON_EXCEPTION_RETURN_(table)
-	tableAddColumn(env, &table, AIDA_FLOAT_TYPE, xData, false);
-	ON_EXCEPTION_RETURN_(table)
-	tableAddColumn(env, &table, AIDA_FLOAT_TYPE, yData, false);
-	ON_EXCEPTION_RETURN_(table)
-	tableAddColumn(env, &table, AIDA_FLOAT_TYPE, tmitData, false);
-	ON_EXCEPTION_RETURN_(table)
-	tableAddColumn(env, &table, AIDA_FLOAT_TYPE, zData, false);
-	ON_EXCEPTION_RETURN_(table)
-	tableAddColumn(env, &table, AIDA_INTEGER_TYPE, hstasData, false);
-	ON_EXCEPTION_RETURN_(table)
-	tableAddColumn(env, &table, AIDA_INTEGER_TYPE, statsData, false);
+		for (int row = 0; row < rows; row++) {
+			int from = order ? order[row] : row;
+			xData[row] = orbit->xData[from];
+			yData[row] = orbit->yData[from];
+			tmitData[row] = orbit->tmitData[from];
+			zData[row] = orbit->zData[from];
+			ageData[row] = age;
+			hstasData[row] = orbit->hstasData[from];
+			statsData[row] = orbit->statsData[from];
+			bpmdData[row] = orbit->bpmd;
+
+			// Names are fixed width so null terminate each one
+			names[row] = nameData + row * (NAME_SIZE + 1);
+			memcpy(names[row], orbit->namesData[from], NAME_SIZE);
+			names[row][NAME_SIZE] = 0x0;
+		}
 
-	endAcquireBpmData(env);
+		tableAppendChunk(env, &table, rows, columns, true);
+		if ((*env)->ExceptionCheck(env)) {
+			releaseTable(table);
+			table.columnCount = 0;
+		}
+	}
+	free(names);
 
-	// All read successfully
 	return table;
 }
 
+/**
+ * Get the order of the BPMs in the given orbit sorted by z position.  This is cached for each
+ * measurement definition and only recomputed when its BPM names or z positions change,
+ * which is almost never
+ *
+ * @param env to be used to throw exceptions using aidaThrow() and aidaThrowNonOsException()
+ * @param orbit the orbit, in display order
+ * @return the display order row of each z ordered row, valid until the next call, or NULL if it could not be allocated
+ */
+static const int* bpmZOrder(JNIEnv* env, BpmOrbit* orbit)
+{
+	int rows = orbit->rows;
+	BpmZOrder* zOrder = NULL, * oldest = NULL;
+
+	for (int i = 0; i < MAX_BPM_Z_ORDERS; i++) {
+		if (bpmZOrders[i].bpmd == orbit->bpmd) {
+			zOrder = &bpmZOrders[i];
+			break;
+		}
+		if (!oldest || bpmZOrders[i].lastUsed < oldest->lastUsed) {
+			oldest = &bpmZOrders[i];
+		}
+	}
+
+	// Use the cached order if the BPMs and their z positions are unchanged
+	if (zOrder && zOrder->rows == rows
+			&& memcmp(zOrder->zData, orbit->zData, rows * sizeof(float)) == 0
+			&& memcmp(zOrder->namesData, orbit->namesData, rows * NAME_SIZE) == 0) {
+		zOrder->lastUsed = ++bpmZOrdersClock;
+		return zOrder->order;
+	}
+
+	if (!zOrder) {
+		zOrder = oldest;
+	}
+	free(zOrder->zData);
+	memset(zOrder, 0, sizeof(BpmZOrder));
+
+	// One block for the z positions, the order, and the names
+	zOrder->zData = ALLOCATE_MEMORY(env, rows * (sizeof(float) + sizeof(int) + NAME_SIZE), "BPM z order");
+	if (!zOrder->zData) {
+		return NULL;
+	}
+	zOrder->order = (int*)(zOrder->zData + rows);
+	zOrder->namesData = (char (*)[NAME_SIZE])(zOrder->order + rows);
+	memcpy(zOrder->zData, orbit->zData, rows * sizeof(float));
+	memcpy(zOrder->namesData, orbit->namesData, rows * NAME_SIZE);
+
+	// Sort the rows by z
+	for (int row = 0; row < rows; row++) {
+		zOrder->order[row] = row;
+	}
+	sortingZData = zOrder->zData;
+	qsort(zOrder->order, rows, sizeof(int), compareZ);
+
+	zOrder->bpmd = orbit->bpmd;
+	zOrder->rows = rows;
+	zOrder->lastUsed = ++bpmZOrdersClock;
+	return zOrder->order;
+}
+
+/**
+ * Compare the z positions of two rows, for qsort(), keeping rows with the same z in display order
+ *
+ * @param a the first row
+ * @param b the second row
+ * @return less than, equal to, or greater than zero, as the first row comes before, with, or after the second
+ */
+static int compareZ(const void* a, const void* b)
+{
+	int rowA = *(const int*)a, rowB = *(const int*)b;
+	if (sortingZData[rowA] != sortingZData[rowB]) {
+		return sortingZData[rowA] < sortingZData[rowB] ? -1 : 1;
+	}
+	return rowA - rowB;
+}
+
 /**
  * Check the arguments throwing an exception if there are any problems
  * @param env
- * @param bpmd
+ * @param bpmds
+ * @param bpmdCount
  * @param navg
  * @param cnfnum
  * @param sortOrder
  * @param cnftype
+ * @param maxAge
  * @return
  */
-static int checkArguments(JNIEnv* env, int bpmd, int navg, int cnfnum, int sortOrder, int cnftype)
+static int checkArguments(JNIEnv* env, const int* bpmds, int bpmdCount, int navg, int cnfnum, int sortOrder, int cnftype,
+		float maxAge)
 {
-	if (bpmd <= 0) {
+	if (bpmdCount <= 0) {
 		aidaThrowNonOsException(env, UNABLE_TO_GET_DATA_EXCEPTION,
 				"(+ve) BPMD param is required for acq of BPM orbits");
 		return EXIT_FAILURE;
 	}
 
+	for (int i = 0; i < bpmdCount; i++) {
+		if (bpmds[i] <= 0) {
+			aidaThrowNonOsException(env, UNABLE_TO_GET_DATA_EXCEPTION,
+					"(+ve) BPMD param is required for acq of BPM orbits");
+			return EXIT_FAILURE;
+		}
+
+		// Each measurement definition only once
+		for (int j = 0; j < i; j++) {
+			if (bpmds[j] == bpmds[i]) {
+				aidaThrowNonOsException(env, UNABLE_TO_GET_DATA_EXCEPTION,
+						"BPMDS argument contains the same measurement definition more than once");
+				return EXIT_FAILURE;
+			}
+		}
+	}
+
 	// Check n is rational
 	if (navg <= 0 || navg > 10000) {
 		aidaThrowNonOsException(env, UNABLE_TO_GET_DATA_EXCEPTION, "N argument (N avg / N turns) is out of range");
@@ -207,25 +631,24 @@ static int checkArguments(JNIEnv* env, int bpmd, int navg, int cnfnum, int sortO
 		return EXIT_FAILURE;
 	}
 
+	// Check max age
+	if (maxAge < 0.0f) {
+		aidaThrowNonOsException(env, UNABLE_TO_GET_DATA_EXCEPTION, "MAXAGE argument out of range");
+		return EXIT_FAILURE;
+	}
+
 	return EXIT_SUCCESS;
 }
 
 /**
- * Acquire BPM Data and return the number of readings returned in rows
+ * Start a BPM Data acquisition session, in which any number of acquisitions can be made
  *
  * @param env
- * @param rows
- * @param bpmd
- * @param n
- * @param cnftype
- * @param cnfnum
- * @param sortOrder
  * @return
  */
-static int acquireBpmData(JNIEnv* env, int* rows, int bpmd, int n, int cnftype, int cnfnum, int sortOrder)
+static int startAcquireBpmData(JNIEnv* env)
 {
 	vmsstat_t status = 0;
-	int4u bpmCount = 0;
 
 	// Initialise acquisition
 	status = DPSLCBPM_ACQINIT();
@@ -234,6 +657,26 @@ static int acquireBpmData(JNIEnv* env, int* rows, int bpmd, int n, int cnftype,
 		return EXIT_FAILURE;
 	}
 
+	return EXIT_SUCCESS;
+}
+
+/**
+ * Acquire BPM Data and return the number of readings returned in rows.
+ * The acquisition session is ended if the acquisition fails
+ *
+ * @param env
+ * @param rows
+ * @param bpmd
+ * @param n
+ * @param cnftype
+ * @param cnfnum
+ * @return
+ */
+static int acquireBpmData(JNIEnv* env, int* rows, int bpmd, int n, int cnftype, int cnfnum)
+{
+	vmsstat_t status = 0;
+	int4u bpmCount = 0;
+
 	// Acquire BPM values
 	status = DPSLCBPM_BPMACQ(&bpmCount, bpmd, n, cnftype, cnfnum);
 	if (!$VMS_STATUS_SUCCESS(status)) {
@@ -242,15 +685,7 @@ static int acquireBpmData(JNIEnv* env, int* rows, int bpmd, int n, int cnftype,
 		return EXIT_FAILURE;
 	}
 
-	/* Reorder the BPM data by Z if that was required */
-	if (sortOrder == SORTORDER_Z) {
-		DPSLCBPM_SORTBYZ(bpmCount);
-	}
-
 	*rows = bpmCount;
-	if (bpmCount == 0) {
-		return EXIT_FAILURE;
-	}
 	return EXIT_SUCCESS;
 }
 
@@ -268,7 +703,7 @@ static int acquireBpmData(JNIEnv* env, int* rows, int bpmd, int n, int cnftype,
  * @return
  */
 static int getBpmData(JNIEnv* env,
-		char namesData[MAX_DGRP_BPMS][NAME_SIZE], float* xData, float* yData, float* tmitData, float* zData,
+		char namesData[][NAME_SIZE], float* xData, float* yData, float* tmitData, float* zData,
 		int4u* hstasData, int4u* statsData)
 {
 	vmsstat_t status;
@@ -322,4 +757,3 @@ static int endAcquireBpmData(JNIEnv* env)
 
 	return EXIT_SUCCESS;
 }
-
@@ -30,6 +30,61 @@ extern "C" {
 #define CNFTYPE_NORMAL  4
 #define CNFTYPE_TEMPORARY  5
 
+#define MAX_BPM_SNAPSHOTS  16               // Most orbit snapshots held at once
+#define BPM_SNAPSHOT_IDLE_EXPIRY  300.0     // Seconds a snapshot is kept without being requested
+#define MAX_BPM_Z_ORDERS  16                // Most measurement definitions whose z order is cached
+#define MAX_BPMDS  MAX_BPM_SNAPSHOTS        // Most measurement definitions in one request
+
+/**
+ * An acquired BPM orbit.  All the data is held in one block allocated at xData, whose
+ * floating point vectors are contiguous and already converted to ieee format.
+ * The block is kept, and reused, for subsequent acquisitions of up to capacity rows
+ */
+typedef struct
+{
+	int bpmd;
+	int rows;
+	int capacity;
+	double acquired;                // When the orbit was acquired, in seconds
+	float* xData;
+	float* yData;
+	float* tmitData;
+	float* zData;
+	int4u* hstasData;
+	int4u* statsData;
+	char (* namesData)[NAME_SIZE];
+} BpmOrbit;
+
+/**
+ * The order of the BPMs of a measurement definition sorted by z position, along with
+ * the BPM names and z positions, in display order, that it was computed from.
+ * All the data is held in one block allocated at zData
+ */
+typedef struct
+{
+	int bpmd;                       // BPMD_ROGUE when not in use
+	int rows;
+	unsigned long lastUsed;
+	float* zData;
+	int* order;                     // Display order row of each z ordered row
+	char (* namesData)[NAME_SIZE];
+} BpmZOrder;
+
+/**
+ * The latest orbit acquired for a measurement definition, double buffered so that a new orbit is
+ * acquired into the buffer not being served, and only replaces the latest orbit once it is complete
+ */
+typedef struct
+{
+	int bpmd;                       // BPMD_ROGUE when the snapshot is not in use
+	int n;
+	int cnftype;
+	int cnfnum;
+	double lastRequested;           // When the snapshot was last requested, in seconds
+	int current;                    // Index of the latest orbit
+	BpmOrbit orbits[2];
+} BpmSnapshot;
+
 #define CHECK_VMS_STATUS \
 if (!$VMS_STATUS_SUCCESS(status)) { \
     endAcquireBpmData(env); \
@@ -3,6 +3,8 @@
  *     **MEMBER**=SLCLIBS:AIDA_PVALIB
  *     **ATTRIBUTES**=JNI,LIBR_NOGLOBAL
  */
+#include <math.h>                 /* sqrt() */
+#include <stddef.h>               /* offsetof() */
 #include "aida_pva.h"
 #include "AIDASLCBPMBUFF_SERVER.h"
 
@@ -10,12 +12,19 @@ static int
 acquireBuffAcqData(JNIEnv* env, int* rows, int nDevices, DEVICE_NAME_TS* deviceNames, char* dGroupName,
 		int bpmd,
 		int nrpos, int timeout);
-static int getBuffAcqData(JNIEnv* env,
-		char** namesData,
-		float* xData, float* yData, float* tmitData, unsigned long* pulseIdData,
-		int2u* statsData, int2u* goodMeasData);
+static int getBuffAcqData(JNIEnv* env, Table* table, int rows, int cursor);
+static Table getBuffAcqStatistics(JNIEnv* env, int rows, int nDevices);
+static BuffStatistics* findBuffStatistics(JNIEnv* env, const char* name, BuffStatistics* statistics, int* nStatistics,
+		int nDevices, int* index, unsigned int indexMask);
+static void accumulateBuffStatistics(BuffStatistics* statistics, const float* values, bool good);
 static int endAcquireBuffAcq(JNIEnv* env);
-static int checkArguments(JNIEnv* env, int bpmd, int nrpos, int nDevices);
+static int checkArguments(JNIEnv* env, int bpmd, int nrpos, int nDevices, int chunk);
+static BuffStream* findBuffStream(int cursor, double now);
+static BuffStream* newBuffStream(BuffStream* request, double now);
+
+// Streamed acquisitions waiting for their next chunk to be requested
+static BuffStream buffStreams[MAX_BUFF_STREAMS];
+static int lastBuffStreamCursor = 0;
 
 // API Stubs
 VERSION("1.0.0")
@@ -66,6 +75,16 @@ void aidaServiceInit(JNIEnv* env)
  *                ["BPMS:LI02:501", "BPMS:DR12:334"]
  *   DEVS:   json.  List of devices to read
  *   Note: cannot specify both BPMS and DEVS
+ *   CHUNK:   number of pulses to return in each table.  Default is all of them
+ *   CURSOR:  Integer cursor, returned with a chunk, to get the next chunk of pulses.
+ *            All other parameters are taken from the first request
+ *   REDUCE:  Boolean.  Return the statistics of each device's values instead of the values
+ *
+ * If a CHUNK is given then the table has an extra column giving the cursor for the next chunk, or 0 if
+ * it is the last chunk.
+ *
+ * If REDUCE is given then the table instead has one row for each device, giving the mean, rms, min, and max
+ * of its x, y, and tmit values over its good measurements, and the correlation of its x and y values.
  *
  * @param env to be used to throw exceptions using aidaThrow() and aidaThrowNonOsException()
  * @param uri the uri
@@ -77,105 +96,148 @@ Table aidaRequestTable(JNIEnv* env, const char* uri, Arguments arguments)
 	TRACK_ALLOCATED_MEMORY
 
 	// Get arguments
-	int bpmd = BPMD_ROGUE, nrpos = NRPOS_DEFAULT, nDevices = 0, timeout = 3;
+	int bpmd = BPMD_ROGUE, nrpos = NRPOS_DEFAULT, nDevices = 0, timeout = 3, chunk = 0, cursor = 0;
+	unsigned char reduce = false;
 	unsigned int nBpms = 0, nDevs = 0;
 	char** bpms = NULL, ** devices = NULL;
-	DEVICE_NAME_TS deviceNames[MAX_DGRP_BPMS];
+	BuffStream request, * stream = &request;
+	DEVICE_NAME_TS* deviceNames = request.deviceNames;
 	TO_DGROUP(dGroupName, uri)
 
-	if (ascanf(env, &arguments, "%d %od %osa %osa %od",
+	if (ascanf(env, &arguments, "%od %od %osa %osa %od %od %od %ob",
 			"bpmd", &bpmd,
 			"nrpos", &nrpos,
 			"bpms", &bpms, &nBpms,
 			"devs", &devices, &nDevs,
-			"timeout", &timeout
+			"timeout", &timeout,
+			"chunk", &chunk,
+			"cursor", &cursor,
+			"reduce", &reduce
 	)) {
 		RETURN_NULL_TABLE
 	}
 	TRACK_MEMORY(bpms)
 	TRACK_MEMORY(devices)
 
-	if (nBpms && nDevs) {
-		// Only one or the other not both
-		aidaThrowNonOsException(env, UNABLE_TO_GET_DATA_EXCEPTION, "Specify either DEVS or BPMS argument but not both");
+	if (reduce && (chunk || cursor)) {
+		aidaThrowNonOsException(env, UNABLE_TO_GET_DATA_EXCEPTION,
+				"REDUCE can't be combined with the CHUNK or CURSOR arguments");
 		FREE_MEMORY
 		RETURN_NULL_TABLE
-	} else if (nBpms) {
-		for (int i = 0; i < nBpms; i++) {
-			if (pmuFromDeviceName(env, bpms[i],
-					deviceNames[i].prim_s._a,
-					deviceNames[i].micr_s._a,
-					&deviceNames[i].unit_s._i)) {
-				FREE_MEMORY
-				RETURN_NULL_TABLE
-			}
+	}
+
+	double now = aidaTimeNow();
+	if (cursor) {
+		FREE_MEMORY
+
+		// Continue a streamed acquisition
+		if (!(stream = findBuffStream(cursor, now))) {
+			aidaThrowNonOsException(env, UNABLE_TO_GET_DATA_EXCEPTION,
+					"CURSOR not recognised, or its acquisition has completed or expired");
+			RETURN_NULL_TABLE
 		}
-		nDevices += nBpms;
-		bpms = NULL;
-	} else if (nDevs) {
-		for (int i = 0; i < nDevs; i++) {
-			if (pmuFromDeviceName(env, devices[i],
-					deviceNames[i].prim_s._a,
-					deviceNames[i].micr_s._a,
-					&deviceNames[i].unit_s._i)) {
-				FREE_MEMORY
-				RETURN_NULL_TABLE
+	} else {
+		if (nBpms && nDevs) {
+			// Only one or the other not both
+			aidaThrowNonOsException(env, UNABLE_TO_GET_DATA_EXCEPTION,
+					"Specify either DEVS or BPMS argument but not both");
+			FREE_MEMORY
+			RETURN_NULL_TABLE
+		} else if (nBpms) {
+			for (int i = 0; i < nBpms; i++) {
+				if (pmuFromDeviceName(env, bpms[i],
+						deviceNames[i].prim_s._a,
+						deviceNames[i].micr_s._a,
+						&deviceNames[i].unit_s._i)) {
+					FREE_MEMORY
+					RETURN_NULL_TABLE
+				}
 			}
+			nDevices += nBpms;
+			bpms = NULL;
+		} else if (nDevs) {
+			for (int i = 0; i < nDevs; i++) {
+				if (pmuFromDeviceName(env, devices[i],
+						deviceNames[i].prim_s._a,
+						deviceNames[i].micr_s._a,
+						&deviceNames[i].unit_s._i)) {
+					FREE_MEMORY
+					RETURN_NULL_TABLE
+				}
+			}
+			nDevices += nDevs;
+			devices = NULL;
 		}
-		nDevices += nDevs;
-		devices = NULL;
-	}
-	FREE_MEMORY
+		FREE_MEMORY
 
-	// Check arguments
-	if (checkArguments(env, bpmd, nrpos, nDevices)) {
-		RETURN_NULL_TABLE
+		// Check arguments
+		if (checkArguments(env, bpmd, nrpos, nDevices, chunk)) {
+			RETURN_NULL_TABLE
+		}
+
+		request.cursor = 0;
+		request.bpmd = bpmd;
+		request.remaining = nrpos;
+		request.chunk = chunk ? chunk : nrpos;
+		request.timeout = timeout;
+		request.nDevices = nDevices;
+		strcpy(request.dGroupName, dGroupName);
+
+		// Stream the acquisition if it will take more than one chunk
+		if (request.chunk < nrpos) {
+			stream = newBuffStream(&request, now);
+		}
 	}
+	stream->lastRequested = now;
 
-	// Acquire Data
-	int rows;
-	if (acquireBuffAcqData(env, &rows, nDevices, &deviceNames[0], dGroupName, bpmd, nrpos, timeout)) {
+	// Acquire Data, just the next chunk of pulses if streaming
+	int rows, pulses = stream->remaining < stream->chunk ? stream->remaining : stream->chunk;
+	if (acquireBuffAcqData(env, &rows, stream->nDevices, stream->deviceNames, stream->dGroupName, stream->bpmd, pulses,
+			stream->timeout)) {
+		stream->cursor = 0;
 		RETURN_NULL_TABLE
 	}
 
 	// No rows
 	if (!rows) {
+		endAcquireBuffAcq(env);
+		stream->cursor = 0;
 		aidaThrowNonOsException(env, UNABLE_TO_GET_DATA_EXCEPTION, "No rows were retrieved for your query");
 		RETURN_NULL_TABLE
 	}
 
 	if (rows > MAX_DGRP_BPMS * MAX_BUFF_MEAS) {
+		endAcquireBuffAcq(env);
+		stream->cursor = 0;
 		aidaThrowNonOsException(env, UNABLE_TO_GET_DATA_EXCEPTION, "Too many rows returned by this query");
 		RETURN_NULL_TABLE
 	}
 
-	// To hold data
-	char* namesData[rows + 1];
-	float xData[rows + 1], yData[rows + 1], tmitData[rows + 1];
-	unsigned long pulseIdData[rows + 1];
-	int2u statsData[rows + 1], goodMeasData[rows + 1];
+	// Reduce the values of each device to their statistics
+	if (reduce) {
+		return getBuffAcqStatistics(env, rows, stream->nDevices);
+	}
 
-	// Get Buffered Data
-	if (getBuffAcqData(env, namesData, xData, yData, tmitData, pulseIdData, statsData, goodMeasData)) {
-		RETURN_NULL_TABLE
+	// The stream is finished with once its last chunk is acquired
+	stream->remaining -= pulses;
+	int nextCursor = stream->remaining ? stream->cursor : 0;
+	stream->cursor = nextCursor;
+
+	// Make and output table, streaming in the buffered data a chunk at a time
+	Type types[] = { AIDA_STRING_TYPE, AIDA_INTEGER_TYPE, AIDA_FLOAT_TYPE, AIDA_FLOAT_TYPE, AIDA_FLOAT_TYPE,
+					 AIDA_SHORT_TYPE, AIDA_SHORT_TYPE, AIDA_INTEGER_TYPE };
+	Table table = tableCreateStreaming(env, chunk || cursor ? 8 : 7, types);
+	if ((*env)->ExceptionCheck(env)) {
+		endAcquireBuffAcq(env);
+		stream->cursor = 0;
+		return table;
 	}
 
-	// Make and output table
-	Table table = tableCreate(env, rows, 7);
-	ON_EXCEPTION_RETURN_(table)
-	tableAddStringColumn(env, &table, namesData);
-	ON_EXCEPTION_RETURN_(table)
-	tableAddColumn(env, &table, AIDA_INTEGER_TYPE, pulseIdData, false);
-	ON_EXCEPTION_RETURN_(table)
-	tableAddColumn(env, &table, AIDA_FLOAT_TYPE, xData, false);
-	ON_EXCEPTION_RETURN_(table)
-	tableAddColumn(env, &table, AIDA_FLOAT_TYPE, yData, false);
-	ON_EXCEPTION_RETURN_(table)
-	tableAddColumn(env, &table, AIDA_FLOAT_TYPE, tmitData, false);
-	ON_EXCEPTION_RETURN_(table)
-	tableAddColumn(env, &table, AIDA_SHORT_TYPE, statsData, false);
-	ON_EXCEPTION_RETURN_(table)
-	tableAddColumn(env, &table, AIDA_SHORT_TYPE, goodMeasData, false);
+	// Get Buffered Data
+	if (getBuffAcqData(env, &table, rows, nextCursor)) {
+		stream->cursor = 0;
+		return table;
+	}
 
 	endAcquireBuffAcq(env);
 
@@ -183,15 +245,74 @@ Table aidaRequestTable(JNIEnv* env, const char* uri, Arguments arguments)
 	return table;
 }
 
+/**
+ * Find the streamed acquisition with the given cursor, releasing any idle streams on the way
+ *
+ * @param cursor the cursor
+ * @param now the time now, in seconds
+ * @return the stream or NULL if there is none
+ */
+static BuffStream* findBuffStream(int cursor, double now)
+{
+	BuffStream* found = NULL;
+
+	for (int i = 0; i < MAX_BUFF_STREAMS; i++) {
+		BuffStream* stream = &buffStreams[i];
+		if (stream->cursor && now - stream->lastRequested > BUFF_STREAM_IDLE_EXPIRY) {
+			stream->cursor = 0;
+		}
+		if (stream->cursor && stream->cursor == cursor) {
+			found = stream;
+		}
+	}
+
+	return found;
+}
+
+/**
+ * Start a new streamed acquisition for the given request, with a new cursor.
+ * It takes a free stream, or the least recently requested one if none are free
+ *
+ * @param request the request
+ * @param now the time now, in seconds
+ * @return the stream
+ */
+static BuffStream* newBuffStream(BuffStream* request, double now)
+{
+	BuffStream* stream = NULL;
+
+	findBuffStream(0, now);
+	for (int i = 0; i < MAX_BUFF_STREAMS; i++) {
+		if (!buffStreams[i].cursor) {
+			stream = &buffStreams[i];
+			break;
+		}
+		if (!stream || buffStreams[i].lastRequested < stream->lastRequested) {
+			stream = &buffStreams[i];
+		}
+	}
+
+	// Cursors are positive
+	if (++lastBuffStreamCursor <= 0) {
+		lastBuffStreamCursor = 1;
+	}
+
+	// Only the devices given are copied
+	memcpy(stream, request, offsetof(BuffStream, deviceNames) + request->nDevices * sizeof(DEVICE_NAME_TS));
+	stream->cursor = lastBuffStreamCursor;
+	return stream;
+}
+
 /**
  * Check arguments
  * @param env
  * @param bpmd
  * @param nrpos
  * @param nDevices
+ * @param chunk
  * @return
  */
-static int checkArguments(JNIEnv* env, int bpmd, int nrpos, int nDevices)
+static int checkArguments(JNIEnv* env, int bpmd, int nrpos, int nDevices, int chunk)
 {
 	// Check that required param, bpmd, is valid.
 	if (bpmd < BPMD_MIN || bpmd > BPMD_MAX) {
@@ -207,6 +328,13 @@ static int checkArguments(JNIEnv* env, int bpmd, int nrpos, int nDevices)
 		return EXIT_FAILURE;
 	}
 
+	// Check chunk is valid
+	if (chunk < 0 || chunk > NRPOS_MAX) {
+		aidaThrowNonOsException(env, UNABLE_TO_GET_DATA_EXCEPTION,
+				"CHUNK, the number of pulses to return at a time, must be between 1..2800");
+		return EXIT_FAILURE;
+	}
+
 	// Check devices given
 	if (nDevices <= 0) {
 		aidaThrowNonOsException(env, UNABLE_TO_GET_DATA_EXCEPTION, "No devices to acquire were received");
@@ -252,50 +380,262 @@ acquireBuffAcqData(JNIEnv* env, int* rows, int nDevices, DEVICE_NAME_TS* deviceN
 }
 
 /**
- * Get the Buffered Data
+ * Get the Buffered Data, appending it to the given table in chunks of BUFF_CHUNK_ROWS rows
  *
  * @param env
- * @param namesData
- * @param xData
- * @param yData
- * @param tmitData
- * @param pulseIdData
- * @param statsData
- * @param goodMeasData
+ * @param table
+ * @param rows
+ * @param cursor the cursor for the next chunk of pulses, for tables with a cursor column
  * @return
  */
-static int
-getBuffAcqData(JNIEnv* env,
-		char** namesData,
-		float* xData, float* yData, float* tmitData,
-		unsigned long* pulseIdData, int2u* statsData, int2u* goodMeasData)
+static int getBuffAcqData(JNIEnv* env, Table* table, int rows, int cursor)
 {
-	int4u nNames, nPulseId, nXdata, nYdata, ntmit, nstats, ngoodmeas;
-
-	if (!(nNames = DPSLCBUFF_GETNAMES(namesData)) ||
-			!(nPulseId = DPSLCBUFF_GETPULSEIDS(pulseIdData)) ||
-			!(nXdata = DPSLCBUFF_GETXS(xData)) ||
-			!(nYdata = DPSLCBUFF_GETYS(yData)) ||
-			!(ntmit = DPSLCBUFF_GETTMITS(tmitData)) ||
-			!(nstats = DPSLCBUFF_GETSTATS(statsData)) ||
-			!(ngoodmeas = DPSLCBUFF_GETGOODMEASES(goodMeasData))
-			) {
-		endAcquireBuffAcq(env);
-		aidaThrowNonOsException(env, UNABLE_TO_GET_DATA_EXCEPTION, "reading Buffered values");
-		return EXIT_FAILURE;
+	char* namesData[BUFF_CHUNK_ROWS];
+	float xData[BUFF_CHUNK_ROWS], yData[BUFF_CHUNK_ROWS], tmitData[BUFF_CHUNK_ROWS];
+	unsigned long pulseIdData[BUFF_CHUNK_ROWS];
+	int2u statsData[BUFF_CHUNK_ROWS], goodMeasData[BUFF_CHUNK_ROWS];
+	int cursorData[BUFF_CHUNK_ROWS];
+	void* chunk[] = { namesData, pulseIdData, xData, yData, tmitData, statsData, goodMeasData, cursorData };
+
+	for (int row = 0; row < BUFF_CHUNK_ROWS; row++) {
+		cursorData[row] = cursor;
 	}
 
-	// If rows are not homogenous
-	if (!(nNames == nPulseId && nPulseId == nXdata && nXdata == nYdata && nYdata == ntmit && ntmit == nstats
-			&& nstats == ngoodmeas)) {
-		endAcquireBuffAcq(env);
-		aidaThrowNonOsException(env, UNABLE_TO_GET_DATA_EXCEPTION, "non-homologous vectors of data returned");
-		return EXIT_FAILURE;
+	int4u nRows;
+	for (int row = 0; row < rows; row += nRows) {
+		if (!(nRows = DPSLCBUFF_GETROWS(row, BUFF_CHUNK_ROWS, namesData, pulseIdData, xData, yData, tmitData,
+				statsData, goodMeasData))) {
+			endAcquireBuffAcq(env);
+			aidaThrowNonOsException(env, UNABLE_TO_GET_DATA_EXCEPTION, "reading Buffered values");
+			return EXIT_FAILURE;
+		}
+
+		tableAppendChunk(env, table, (int)nRows, chunk, false);
+		if ((*env)->ExceptionCheck(env)) {
+			endAcquireBuffAcq(env);
+			return EXIT_FAILURE;
+		}
 	}
 
 	return EXIT_SUCCESS;
 }
 
+/**
+ * Reduce the Buffered Data to the statistics of each device's values, reading it in chunks of BUFF_CHUNK_ROWS rows,
+ * and end the acquisition.  Only the running statistics of each device are kept so the memory used,
+ * and the size of the table returned, don't grow with the number of pulses
+ *
+ * @param env
+ * @param rows the number of rows acquired
+ * @param nDevices the number of devices acquired
+ * @return a table with one row for each device
+ */
+static Table getBuffAcqStatistics(JNIEnv* env, int rows, int nDevices)
+{
+	char* namesData[BUFF_CHUNK_ROWS];
+	float xData[BUFF_CHUNK_ROWS], yData[BUFF_CHUNK_ROWS], tmitData[BUFF_CHUNK_ROWS];
+	unsigned long pulseIdData[BUFF_CHUNK_ROWS];
+	int2u statsData[BUFF_CHUNK_ROWS], goodMeasData[BUFF_CHUNK_ROWS];
+
+	// One block for the statistics of each device, and an index to find them by name at least twice as big
+	unsigned int indexSize = 1;
+	while (indexSize < 2 * nDevices) {
+		indexSize <<= 1;
+	}
+	BuffStatistics* statistics = ALLOCATE_MEMORY(env, nDevices * sizeof(BuffStatistics) + indexSize * sizeof(int),
+			"buffered data statistics");
+	if (!statistics) {
+		endAcquireBuffAcq(env);
+		RETURN_NULL_TABLE
+	}
+	int* index = (int*)(statistics + nDevices), nStatistics = 0;
+	for (int i = 0; i < indexSize; i++) {
+		index[i] = -1;
+	}
+
+	int4u nRows;
+	for (int row = 0; row < rows; row += nRows) {
+		if (!(nRows = DPSLCBUFF_GETROWS(row, BUFF_CHUNK_ROWS, namesData, pulseIdData, xData, yData, tmitData,
+				statsData, goodMeasData))) {
+			free(statistics);
+			endAcquireBuffAcq(env);
+			aidaThrowNonOsException(env, UNABLE_TO_GET_DATA_EXCEPTION, "reading Buffered values");
+			RETURN_NULL_TABLE
+		}
+
+		CONVERT_FROM_VMS_FLOAT(xData, (int2u)nRows)
+		CONVERT_FROM_VMS_FLOAT(yData, (int2u)nRows)
+		CONVERT_FROM_VMS_FLOAT(tmitData, (int2u)nRows)
+
+		for (int i = 0; i < nRows; i++) {
+			BuffStatistics* deviceStatistics = findBuffStatistics(env, namesData[i], statistics, &nStatistics,
+					nDevices, index, indexSize - 1);
+			if (!deviceStatistics) {
+				free(statistics);
+				endAcquireBuffAcq(env);
+				RETURN_NULL_TABLE
+			}
+			float values[BUFF_STATISTICS_VALUES] = { xData[i], yData[i], tmitData[i] };
+			accumulateBuffStatistics(deviceStatistics, values, goodMeasData[i] != 0);
+		}
+	}
+
+	endAcquireBuffAcq(env);
+	if ((*env)->ExceptionCheck(env)) {
+		free(statistics);
+		RETURN_NULL_TABLE
+	}
+
+	// One block for the columns: name pointers, pulses, good, then the mean, rms, min, and max
+	// of x, y, and tmit, and the x y correlation
+	int nColumns = 3 + 4 * BUFF_STATISTICS_VALUES + 1;
+	char** names = ALLOCATE_MEMORY(env,
+			nStatistics * (sizeof(char*) + 2 * sizeof(int) + (nColumns - 3) * sizeof(float)), "buffered data statistics");
+	if (!names) {
+		free(statistics);
+		RETURN_NULL_TABLE
+	}
+	int* pulsesData = (int*)(names + nStatistics), * goodData = pulsesData + nStatistics;
+	float* floatData = (float*)(goodData + nStatistics);
+
+	for (int i = 0; i < nStatistics; i++) {
+		BuffStatistics* deviceStatistics = &statistics[i];
+		int good = deviceStatistics->good;
+		double mean[BUFF_STATISTICS_VALUES], rms[BUFF_STATISTICS_VALUES];
+
+		names[i] = deviceStatistics->name;
+		pulsesData[i] = deviceStatistics->pulses;
+		goodData[i] = good;
+		for (int value = 0; value < BUFF_STATISTICS_VALUES; value++) {
+			mean[value] = good ? deviceStatistics->sum[value] / good : 0.0;
+			double variance = good ? deviceStatistics->sumOfSquares[value] / good - mean[value] * mean[value] : 0.0;
+			rms[value] = variance > 0.0 ? sqrt(variance) : 0.0;
+
+			float* column = floatData + 4 * value * nStatistics;
+			column[i] = (float)(deviceStatistics->shift[value] + mean[value]);
+			column[i + nStatistics] = (float)rms[value];
+			column[i + 2 * nStatistics] = deviceStatistics->min[value];
+			column[i + 3 * nStatistics] = deviceStatistics->max[value];
+		}
+
+		// Correlation of x and y, 0 if either doesn't vary
+		double covariance = good ? deviceStatistics->sumOfXYProducts / good - mean[0] * mean[1] : 0.0;
+		floatData[4 * BUFF_STATISTICS_VALUES * nStatistics + i] =
+				rms[0] > 0.0 && rms[1] > 0.0 ? (float)(covariance / (rms[0] * rms[1])) : 0.0f;
+	}
+
+	char* fields[] = { "name", "pulses", "good",
+					   "xMean", "xRms", "xMin", "xMax",
+					   "yMean", "yRms", "yMin", "yMax",
+					   "tmitMean", "tmitRms", "tmitMin", "tmitMax",
+					   "xyCorrelation" };
+	char* labels[] = { "BPM Name", "pulses", "good measurements",
+					   "x mean (mm)", "x rms (mm)", "x min (mm)", "x max (mm)",
+					   "y mean (mm)", "y rms (mm)", "y min (mm)", "y max (mm)",
+					   "tmit mean (coulomb)", "tmit rms (coulomb)", "tmit min (coulomb)", "tmit max (coulomb)",
+					   "x y correlation" };
+
+	Table table = tableCreateDynamic(env, nStatistics, nColumns);
+	for (int column = 0; column < nColumns && !(*env)->ExceptionCheck(env); column++) {
+		if (column == 0) {
+			tableAddStringColumn(env, &table, names);
+		} else if (column < 3) {
+			tableAddColumn(env, &table, AIDA_INTEGER_TYPE, column == 1 ? pulsesData : goodData, true);
+		} else {
+			tableAddColumn(env, &table, AIDA_FLOAT_TYPE, floatData + (column - 3) * nStatistics, true);
+		}
+		if (!(*env)->ExceptionCheck(env)) {
+			tableAddField(env, &table, fields[column]);
+		}
+		if (!(*env)->ExceptionCheck(env)) {
+			tableAddLabel(env, &table, labels[column]);
+		}
+	}
+
+	free(names);
+	free(statistics);
+	return table;
+}
+
+/**
+ * Find the statistics of the named device, adding them if they are not there yet
+ *
+ * @param env
+ * @param name the device name
+ * @param statistics the statistics of each device found so far
+ * @param nStatistics the number of devices found so far
+ * @param nDevices the number of devices acquired
+ * @param index the index into the statistics, by hash of the device name, -1 for unused entries
+ * @param indexMask the size of the index, a power of two, less one
+ * @return the device's statistics, or NULL if more devices were found than were acquired
+ */
+static BuffStatistics* findBuffStatistics(JNIEnv* env, const char* name, BuffStatistics* statistics, int* nStatistics,
+		int nDevices, int* index, unsigned int indexMask)
+{
+	unsigned int hash = aidaHash(name);
+	for (unsigned int slot = hash & indexMask;; slot = (slot + 1) & indexMask) {
+		if (index[slot] < 0) {
+			break;
+		}
+		if (strncmp(statistics[index[slot]].name, name, MAX_URI_LEN - 1) == 0) {
+			return &statistics[index[slot]];
+		}
+	}
+
+	if (*nStatistics >= nDevices) {
+		aidaThrowNonOsException(env, UNABLE_TO_GET_DATA_EXCEPTION, "more devices returned than were acquired");
+		return NULL;
+	}
+
+	BuffStatistics* deviceStatistics = &statistics[*nStatistics];
+	memset(deviceStatistics, 0, sizeof(BuffStatistics));
+	strncpy(deviceStatistics->name, name, MAX_URI_LEN - 1);
+
+	for (unsigned int slot = hash & indexMask;; slot = (slot + 1) & indexMask) {
+		if (index[slot] < 0) {
+			index[slot] = (*nStatistics)++;
+			break;
+		}
+	}
+	return deviceStatistics;
+}
+
+/**
+ * Accumulate one pulse's x, y, and tmit values into a device's statistics
+ *
+ * @param statistics the device's statistics
+ * @param values the x, y, and tmit values
+ * @param good true if this is a good measurement, only good measurements are accumulated
+ */
+static void accumulateBuffStatistics(BuffStatistics* statistics, const float* values, bool good)
+{
+	double deviations[BUFF_STATISTICS_VALUES];
+
+	statistics->pulses++;
+	if (!good) {
+		return;
+	}
+
+	if (!statistics->good++) {
+		for (int value = 0; value < BUFF_STATISTICS_VALUES; value++) {
+			statistics->shift[value] = statistics->min[value] = statistics->max[value] = values[value];
+		}
+	}
+
+	for (int value = 0; value < BUFF_STATISTICS_VALUES; value++) {
+		deviations[value] = (double)values[value] - statistics->shift[value];
+		statistics->sum[value] += deviations[value];
+		statistics->sumOfSquares[value] += deviations[value] * deviations[value];
+		if (values[value] < statistics->min[value]) {
+			statistics->min[value] = values[value];
+		}
+		if (values[value] > statistics->max[value]) {
+			statistics->max[value] = values[value];
+		}
+	}
+	statistics->sumOfXYProducts += deviations[0] * deviations[1];
+}
+
 /**
  * End Buffered data acquisition
  *
@@ -313,4 +653,3 @@ static int endAcquireBuffAcq(JNIEnv* env)
 	}
 	return EXIT_SUCCESS;
 }
-
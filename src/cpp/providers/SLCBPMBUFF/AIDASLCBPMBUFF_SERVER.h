@@ -23,6 +23,46 @@ extern "C" {
 #define BPMD_MIN  1
 #define BPMD_MAX 9999
 #define NUMOFFSET 3
+#define BUFF_CHUNK_ROWS 512		// Rows copied out of the acquisition, into the table, at a time
+#define MAX_BUFF_STREAMS 8		// Most streamed acquisitions in progress at once
+#define BUFF_STREAM_IDLE_EXPIRY 60.0	// Seconds a streamed acquisition waits for its next chunk to be requested
+#define BUFF_STATISTICS_VALUES 3		// Values whose statistics are reduced: x, y, and tmit
+
+/**
+ * The statistics of one device's values, over the good measurements of a buffered acquisition.
+ * Each value is accumulated relative to its first good measurement so that the variance
+ * of values with a large mean and small jitter, like tmit, stays accurate
+ */
+typedef struct
+{
+	char name[MAX_URI_LEN];
+	int pulses;
+	int good;                                   // Pulses with a good measurement
+	float shift[BUFF_STATISTICS_VALUES];        // First good measurement of each value
+	double sum[BUFF_STATISTICS_VALUES];
+	double sumOfSquares[BUFF_STATISTICS_VALUES];
+	double sumOfXYProducts;
+	float min[BUFF_STATISTICS_VALUES];
+	float max[BUFF_STATISTICS_VALUES];
+} BuffStatistics;
+
+/**
+ * A buffered acquisition that is returned a chunk of pulses at a time.  Each request for the next chunk,
+ * with the stream's cursor, acquires and returns the next chunk of pulses, so neither the time to the first
+ * data nor the size of each table grows with the total number of pulses
+ */
+typedef struct
+{
+	int cursor;                     // 0 when the stream is not in use
+	int bpmd;
+	int remaining;                  // Pulses still to be acquired
+	int chunk;                      // Pulses acquired for each request
+	int timeout;
+	double lastRequested;           // When the last chunk was requested, in seconds
+	char dGroupName[MAX_URI_LEN];
+	int nDevices;
+	DEVICE_NAME_TS deviceNames[MAX_DGRP_BPMS];
+} BuffStream;
 
 #ifdef __cplusplus
 }
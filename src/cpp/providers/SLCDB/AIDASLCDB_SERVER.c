@@ -9,9 +9,50 @@
  *     **MEMBER**=SLCLIBS:AIDA_PVALIB
  *     **ATTRIBUTES**=JNI,LIBR_NOGLOBAL
  */
+#include <ctype.h>
 #include "aida_pva.h"
 #include "AIDASLCDB_SERVER.h"
 
+static Table getDbValues(JNIEnv* env, Arguments arguments);
+static Table getDbCacheStatistics(JNIEnv* env);
+static Table getDbArrayTable(JNIEnv* env, const char* slcName, const DbTableType* tableType, float maxAge);
+static const DbTableType* dbTableType(const char* typeName);
+static vmsstat_t dbGet(const char* slcName, DbRead read, float maxAge, void* value);
+static vmsstat_t dbRead(const char* slcName, DbRead read, void* value);
+static bool getCachedDbValue(const char* slcName, DbRead read, float maxAge, void* value, double now);
+static void cacheDbValue(const char* slcName, DbRead read, void* value, double now);
+static void invalidateDbCache(const char* slcName);
+static DbCacheEntry* findDbCacheEntry(const char* slcName, DbRead read, unsigned int hash);
+static void releaseDbCacheEntry(DbCacheEntry* entry);
+static size_t dbValueSize(DbRead read, void* value);
+static bool isDbName(const char* name);
+static Type dbValueType(const char* typeName);
+static char* dbValueString(DbValue* value);
+
+// The SLC database value cache, organised as DB_CACHE_SETS sets of DB_CACHE_WAYS entries, and its statistics
+static DbCacheEntry dbCache[DB_CACHE_SETS * DB_CACHE_WAYS];
+static DbCacheStatistics dbCacheStatistics;
+
+// The TABLE_TYPEs that SLC database values can be returned as, sorted by the aidaHash() of their names so that
+// a name can be found by a binary search of its hash
+static const DbTableType dbTableTypes[] = {
+		{ "BYTE", 0x0d75df9fu, AIDA_BYTE_TYPE, DB_READ_BYTE },
+		{ "SHORT", 0x21ec44b5u, AIDA_SHORT_TYPE, DB_READ_SHORT },
+		{ "SHORT_ARRAY", 0x48cb4607u, AIDA_SHORT_ARRAY_TYPE, DB_READ_SHORT_ARRAY },
+		{ "INTEGER_ARRAY", 0x51f80bb7u, AIDA_INTEGER_ARRAY_TYPE, DB_READ_INT_ARRAY },
+		{ "LONG_ARRAY", 0x55359519u, AIDA_LONG_ARRAY_TYPE, DB_READ_INT_ARRAY },
+		{ "BOOLEAN", 0x880b7e9fu, AIDA_BOOLEAN_TYPE, DB_READ_INT },
+		{ "FLOAT", 0x8a18cfa5u, AIDA_FLOAT_TYPE, DB_READ_FLOAT },
+		{ "INTEGER", 0x8d1d3425u, AIDA_INTEGER_TYPE, DB_READ_INT },
+		{ "BYTE_ARRAY", 0x8fc8995du, AIDA_BYTE_ARRAY_TYPE, DB_READ_BYTE_ARRAY },
+		{ "LONG", 0xc0de1353u, AIDA_LONG_TYPE, DB_READ_INT },
+		{ "FLOAT_ARRAY", 0xc73acb37u, AIDA_FLOAT_ARRAY_TYPE, DB_READ_FLOAT_ARRAY },
+		{ "DOUBLE_ARRAY", 0xd59570f6u, AIDA_DOUBLE_ARRAY_TYPE, DB_READ_FLOAT_ARRAY },
+		{ "DOUBLE", 0xdf980448u, AIDA_DOUBLE_TYPE, DB_READ_FLOAT },
+		{ "BOOLEAN_ARRAY", 0xf2b9405du, AIDA_BOOLEAN_ARRAY_TYPE, DB_READ_INT_ARRAY },
+		{ "STRING", 0xf6097378u, AIDA_STRING_TYPE, DB_READ_STRING },
+};
+
 // API Stubs
 VERSION("1.0.0")
 SET_STUB_TABLE
@@ -43,8 +84,9 @@ void aidaServiceInit(JNIEnv* env)
 int aidaRequestBoolean(JNIEnv* env, const char* uri, Arguments arguments)
 {
 	int val = 0;
+	GET_MAX_AGE_OR_RETURN_(maxAge, 0)
 	TO_SLC_NAME(uri, slcName)
-	vmsstat_t status = JNI_DBGETINT(slcName, &val);
+	vmsstat_t status = dbGet(slcName, DB_READ_INT, maxAge, &val);
 
 	if (!SUCCESS(status)) {
 		aidaThrow(env, status, UNABLE_TO_GET_DATA_EXCEPTION, "getting SLC db boolean device data");
@@ -65,8 +107,9 @@ int aidaRequestBoolean(JNIEnv* env, const char* uri, Arguments arguments)
 char aidaRequestByte(JNIEnv* env, const char* uri, Arguments arguments)
 {
 	unsigned char val = 0;
+	GET_MAX_AGE_OR_RETURN_(maxAge, 0)
 	TO_SLC_NAME(uri, slcName)
-	vmsstat_t status = JNI_DBGETBYTE(slcName, &val);
+	vmsstat_t status = dbGet(slcName, DB_READ_BYTE, maxAge, &val);
 
 	if (!SUCCESS(status)) {
 		aidaThrow(env, status, UNABLE_TO_GET_DATA_EXCEPTION, "getting SLC db byte device data");
@@ -86,8 +129,9 @@ char aidaRequestByte(JNIEnv* env, const char* uri, Arguments arguments)
 short aidaRequestShort(JNIEnv* env, const char* uri, Arguments arguments)
 {
 	short int val = 0;
+	GET_MAX_AGE_OR_RETURN_(maxAge, 0)
 	TO_SLC_NAME(uri, slcName)
-	vmsstat_t status = JNI_DBGETSHORT(slcName, &val);
+	vmsstat_t status = dbGet(slcName, DB_READ_SHORT, maxAge, &val);
 
 	if (!SUCCESS(status)) {
 		aidaThrow(env, status, UNABLE_TO_GET_DATA_EXCEPTION, "getting SLC db short device data");
@@ -107,8 +151,9 @@ short aidaRequestShort(JNIEnv* env, const char* uri, Arguments arguments)
 int aidaRequestInteger(JNIEnv* env, const char* uri, Arguments arguments)
 {
 	int val = 0;
+	GET_MAX_AGE_OR_RETURN_(maxAge, 0)
 	TO_SLC_NAME(uri, slcName)
-	vmsstat_t status = JNI_DBGETINT(slcName, &val);
+	vmsstat_t status = dbGet(slcName, DB_READ_INT, maxAge, &val);
 
 	if (!SUCCESS(status)) {
 		aidaThrow(env, status, UNABLE_TO_GET_DATA_EXCEPTION, "getting SLC db integer device data");
@@ -128,8 +173,9 @@ int aidaRequestInteger(JNIEnv* env, const char* uri, Arguments arguments)
 long aidaRequestLong(JNIEnv* env, const char* uri, Arguments arguments)
 {
 	int val = 0;
+	GET_MAX_AGE_OR_RETURN_(maxAge, 0)
 	TO_SLC_NAME(uri, slcName)
-	vmsstat_t status = JNI_DBGETINT(slcName, &val);
+	vmsstat_t status = dbGet(slcName, DB_READ_INT, maxAge, &val);
 
 	if (!SUCCESS(status)) {
 		aidaThrow(env, status, UNABLE_TO_GET_DATA_EXCEPTION, "getting SLC db long device data");
@@ -149,8 +195,9 @@ long aidaRequestLong(JNIEnv* env, const char* uri, Arguments arguments)
 float aidaRequestFloat(JNIEnv* env, const char* uri, Arguments arguments)
 {
 	float val = 0.0f; /* Returned in ieee format */
+	GET_MAX_AGE_OR_RETURN_(maxAge, 0.0f)
 	TO_SLC_NAME(uri, slcName)
-	vmsstat_t status = JNI_DBGETFLOAT(slcName, &val);
+	vmsstat_t status = dbGet(slcName, DB_READ_FLOAT, maxAge, &val);
 
 	if (!SUCCESS(status)) {
 		aidaThrow(env, status, UNABLE_TO_GET_DATA_EXCEPTION, "getting SLC db floating point device data");
@@ -170,8 +217,9 @@ float aidaRequestFloat(JNIEnv* env, const char* uri, Arguments arguments)
 double aidaRequestDouble(JNIEnv* env, const char* uri, Arguments arguments)
 {
 	float val = 0.0f; /* Returned in ieee format */
+	GET_MAX_AGE_OR_RETURN_(maxAge, 0.0f)
 	TO_SLC_NAME(uri, slcName)
-	vmsstat_t status = JNI_DBGETFLOAT(slcName, &val);
+	vmsstat_t status = dbGet(slcName, DB_READ_FLOAT, maxAge, &val);
 
 	if (!SUCCESS(status)) {
 		aidaThrow(env, status, UNABLE_TO_GET_DATA_EXCEPTION, "getting SLC db double device data");
@@ -191,8 +239,9 @@ double aidaRequestDouble(JNIEnv* env, const char* uri, Arguments arguments)
 char* aidaRequestString(JNIEnv* env, const char* uri, Arguments arguments)
 {
 	char* val = NULL;
+	GET_MAX_AGE_OR_RETURN_(maxAge, NULL)
 	TO_SLC_NAME(uri, slcName)
-	vmsstat_t status = JNI_DBGETSTRING(slcName, &val);
+	vmsstat_t status = dbGet(slcName, DB_READ_STRING, maxAge, &val);
 
 	if (!SUCCESS(status)) {
 		aidaThrow(env, status, UNABLE_TO_GET_DATA_EXCEPTION, "getting SLC db string device data");
@@ -215,8 +264,9 @@ Array aidaRequestBooleanArray(JNIEnv* env, const char* uri, Arguments arguments)
 	booleanArray.count = 0;
 	booleanArray.items = NULL;
 
+	GET_MAX_AGE_OR_RETURN_(maxAge, booleanArray)
 	TO_SLC_NAME(uri, slcName)
-	vmsstat_t status = JNI_DBGETINTA(slcName, (int**)(&booleanArray.items));
+	vmsstat_t status = dbGet(slcName, DB_READ_INT_ARRAY, maxAge, (int**)(&booleanArray.items));
 
 	if (!SUCCESS(status)) {
 		aidaThrow(env, status, UNABLE_TO_GET_DATA_EXCEPTION, "getting SLC db boolean array device data");
@@ -246,8 +296,9 @@ Array aidaRequestByteArray(JNIEnv* env, const char* uri, Arguments arguments)
 	byteArray.count = 0;
 	byteArray.items = NULL;
 
+	GET_MAX_AGE_OR_RETURN_(maxAge, byteArray)
 	TO_SLC_NAME(uri, slcName)
-	vmsstat_t status = JNI_DBGETBYTEA(slcName, (unsigned char**)(&byteArray.items));
+	vmsstat_t status = dbGet(slcName, DB_READ_BYTE_ARRAY, maxAge, (unsigned char**)(&byteArray.items));
 
 	if (!SUCCESS(status)) {
 		aidaThrow(env, status, UNABLE_TO_GET_DATA_EXCEPTION, "getting SLC db byte array device data");
@@ -272,8 +323,9 @@ Array aidaRequestShortArray(JNIEnv* env, const char* uri, Arguments arguments)
 	shortArray.count = 0;
 	shortArray.items = NULL;
 
+	GET_MAX_AGE_OR_RETURN_(maxAge, shortArray)
 	TO_SLC_NAME(uri, slcName)
-	vmsstat_t status = JNI_DBGETSHORTA(slcName, (short**)(&shortArray.items));
+	vmsstat_t status = dbGet(slcName, DB_READ_SHORT_ARRAY, maxAge, (short**)(&shortArray.items));
 	TRACK_MEMORY(shortArray.items)
 
 	if (!SUCCESS(status)) {
@@ -309,8 +361,9 @@ Array aidaRequestIntegerArray(JNIEnv* env, const char* uri, Arguments arguments)
 	integerArray.count = 0;
 	integerArray.items = NULL;
 
+	GET_MAX_AGE_OR_RETURN_(maxAge, integerArray)
 	TO_SLC_NAME(uri, slcName)
-	vmsstat_t status = JNI_DBGETINTA(slcName, (int**)(&integerArray.items));
+	vmsstat_t status = dbGet(slcName, DB_READ_INT_ARRAY, maxAge, (int**)(&integerArray.items));
 	TRACK_MEMORY(integerArray.items)
 
 	if (!SUCCESS(status)) {
@@ -346,8 +399,9 @@ Array aidaRequestLongArray(JNIEnv* env, const char* uri, Arguments arguments)
 	longArray.count = 0;
 	longArray.items = NULL;
 
+	GET_MAX_AGE_OR_RETURN_(maxAge, longArray)
 	TO_SLC_NAME(uri, slcName)
-	vmsstat_t status = JNI_DBGETINTA(slcName, (int**)(&longArray.items));
+	vmsstat_t status = dbGet(slcName, DB_READ_INT_ARRAY, maxAge, (int**)(&longArray.items));
 	TRACK_MEMORY(longArray.items)
 
 	if (!SUCCESS(status)) {
@@ -385,8 +439,9 @@ Array aidaRequestFloatArray(JNIEnv* env, const char* uri, Arguments arguments)
 	floatArray.count = 0;
 	floatArray.items = NULL;
 
+	GET_MAX_AGE_OR_RETURN_(maxAge, floatArray)
 	TO_SLC_NAME(uri, slcName)
-	vmsstat_t status = JNI_DBGETFLOATA(slcName, (float**)(&floatArray.items));
+	vmsstat_t status = dbGet(slcName, DB_READ_FLOAT_ARRAY, maxAge, (float**)(&floatArray.items));
 	TRACK_MEMORY(floatArray.items)
 
 	if (!SUCCESS(status)) {
@@ -422,8 +477,9 @@ Array aidaRequestDoubleArray(JNIEnv* env, const char* uri, Arguments arguments)
 	doubleArray.count = 0;
 	doubleArray.items = NULL;
 
+	GET_MAX_AGE_OR_RETURN_(maxAge, doubleArray)
 	TO_SLC_NAME(uri, slcName)
-	vmsstat_t status = JNI_DBGETFLOATA(slcName, (float**)(&doubleArray.items));
+	vmsstat_t status = dbGet(slcName, DB_READ_FLOAT_ARRAY, maxAge, (float**)(&doubleArray.items));
 	TRACK_MEMORY(doubleArray.items)
 
 	if (!SUCCESS(status)) {
@@ -512,7 +568,9 @@ StringArray aidaRequestStringArray(JNIEnv* env, const char* uri, Arguments argum
 }
 
 /**
- * Get a table of data
+ * Get a table of data.
+ * For the `DBGET:VALUES` channel this is a table of the values of many PVs, see getDbValues(),
+ * and for the `DBGET:CACHE_STATS` channel the statistics of the value cache, see getDbCacheStatistics()
  *
  * @param env to be used to throw exceptions using aidaThrow() and aidaThrowNonOsException()
  * @param uri the uri
@@ -521,124 +579,108 @@ StringArray aidaRequestStringArray(JNIEnv* env, const char* uri, Arguments argum
  */
 Table aidaRequestTable(JNIEnv* env, const char* uri, Arguments arguments)
 {
+	// Multi-PV get, and value cache statistics
+	if (startsWith(uri, "DBGET")) {
+		if (endsWith(uri, "CACHE_STATS")) {
+			return getDbCacheStatistics(env);
+		}
+		return getDbValues(env, arguments);
+	}
+
 	// Get table type parameter
 	char* specifiedType;
 	if (ascanf(env, &arguments, "%s", "TABLE_TYPE", &specifiedType)) {
 		RETURN_NULL_TABLE
 	}
 
+	const DbTableType* tableType = dbTableType(specifiedType);
+	free(specifiedType);
+	if (!tableType) {
+		aidaThrowNonOsException(env, UNSUPPORTED_CHANNEL_EXCEPTION,
+				"TABLE_TYPE is not a type that SLC db device data can be returned as");
+		RETURN_NULL_TABLE
+	}
+
 	// Make a table
 	Table table;
 	memset(&table, 0, sizeof(table));
 	table.columnCount = 0;
 
-	// Add column based on TYPE
-	if (strcasecmp(specifiedType, "FLOAT") == 0) {
+	// Arrays are unpacked straight from the database buffer into the table column
+	if (tableType->type >= AIDA_BOOLEAN_ARRAY_TYPE) {
+		GET_MAX_AGE_OR_RETURN_(maxAge, table)
+		TO_SLC_NAME(uri, slcName)
+		return getDbArrayTable(env, slcName, tableType, maxAge);
+	}
+
+	// Add a single row column based on TYPE
+	switch (tableType->type) {
+	case AIDA_FLOAT_TYPE: {
 		float value = aidaRequestFloat(env, uri, arguments);
 		ON_EXCEPTION_RETURN_(table)
 		table = tableCreate(env, 1, 1);
 		ON_EXCEPTION_RETURN_(table)
 		tableAddSingleRowFloatColumn(env, &table, value, true);
-		ON_EXCEPTION_RETURN_(table)
-	} else if (strcasecmp(specifiedType, "DOUBLE") == 0) {
+		break;
+	}
+	case AIDA_DOUBLE_TYPE: {
 		double value = aidaRequestDouble(env, uri, arguments);
 		ON_EXCEPTION_RETURN_(table)
 		table = tableCreate(env, 1, 1);
 		ON_EXCEPTION_RETURN_(table)
-		tableAddSingleRowDoubleColumn(env, &table, true, false);
-		ON_EXCEPTION_RETURN_(table)
-	} else if (strcasecmp(specifiedType, "BYTE") == 0) {
+		tableAddSingleRowDoubleColumn(env, &table, value, true);
+		break;
+	}
+	case AIDA_BYTE_TYPE: {
 		char value = aidaRequestByte(env, uri, arguments);
 		ON_EXCEPTION_RETURN_(table)
 		table = tableCreate(env, 1, 1);
 		ON_EXCEPTION_RETURN_(table)
 		tableAddSingleRowByteColumn(env, &table, value);
-		ON_EXCEPTION_RETURN_(table)
-	} else if (strcasecmp(specifiedType, "SHORT") == 0) {
+		break;
+	}
+	case AIDA_SHORT_TYPE: {
 		short value = aidaRequestShort(env, uri, arguments);
 		ON_EXCEPTION_RETURN_(table)
 		table = tableCreate(env, 1, 1);
 		ON_EXCEPTION_RETURN_(table)
 		tableAddSingleRowShortColumn(env, &table, value);
-		ON_EXCEPTION_RETURN_(table)
-	} else if (strcasecmp(specifiedType, "INTEGER") == 0) {
+		break;
+	}
+	case AIDA_INTEGER_TYPE: {
 		int value = aidaRequestInteger(env, uri, arguments);
 		ON_EXCEPTION_RETURN_(table)
 		table = tableCreate(env, 1, 1);
 		ON_EXCEPTION_RETURN_(table)
 		tableAddSingleRowIntegerColumn(env, &table, value);
-		ON_EXCEPTION_RETURN_(table)
-	} else if (strcasecmp(specifiedType, "LONG") == 0) {
+		break;
+	}
+	case AIDA_LONG_TYPE: {
 		long value = aidaRequestLong(env, uri, arguments);
 		ON_EXCEPTION_RETURN_(table)
 		table = tableCreate(env, 1, 1);
 		ON_EXCEPTION_RETURN_(table)
 		tableAddSingleRowLongColumn(env, &table, value);
-		ON_EXCEPTION_RETURN_(table)
-	} else if (strcasecmp(specifiedType, "BOOLEAN") == 0) {
+		break;
+	}
+	case AIDA_BOOLEAN_TYPE: {
 		int value = aidaRequestBoolean(env, uri, arguments);
 		ON_EXCEPTION_RETURN_(table)
 		table = tableCreate(env, 1, 1);
 		ON_EXCEPTION_RETURN_(table)
 		tableAddSingleRowBooleanColumn(env, &table, value);
-		ON_EXCEPTION_RETURN_(table)
-	} else if (strcasecmp(specifiedType, "STRING") == 0) {
+		break;
+	}
+	default: {
 		char* value = aidaRequestString(env, uri, arguments);
 		ON_EXCEPTION_RETURN_(table)
 		table = tableCreate(env, 1, 1);
-		ON_EXCEPTION_RETURN_(table)
-		tableAddSingleRowStringColumn(env, &table, value);
-		ON_EXCEPTION_RETURN_(table)
-
-	} else if (strcasecmp(specifiedType, "FLOAT_ARRAY") == 0) {
-		Array value = aidaRequestFloatArray(env, uri, arguments);
-		ON_EXCEPTION_RETURN_(table)
-		table = tableCreate(env, value.count, 1);
-		ON_EXCEPTION_RETURN_(table)
-		tableAddColumn(env, &table, AIDA_FLOAT_ARRAY_TYPE, value.items, true);
-		ON_EXCEPTION_RETURN_(table)
-	} else if (strcasecmp(specifiedType, "DOUBLE_ARRAY") == 0) {
-		Array value = aidaRequestDoubleArray(env, uri, arguments);
-		ON_EXCEPTION_RETURN_(table)
-		table = tableCreate(env, value.count, 1);
-		ON_EXCEPTION_RETURN_(table)
-		tableAddColumn(env, &table, AIDA_DOUBLE_ARRAY_TYPE, value.items, true);
-		ON_EXCEPTION_RETURN_(table)
-	} else if (strcasecmp(specifiedType, "BYTE_ARRAY") == 0) {
-		Array value = aidaRequestByteArray(env, uri, arguments);
-		ON_EXCEPTION_RETURN_(table)
-		table = tableCreate(env, value.count, 1);
-		ON_EXCEPTION_RETURN_(table)
-		tableAddColumn(env, &table, AIDA_BYTE_ARRAY_TYPE, value.items, false);
-		ON_EXCEPTION_RETURN_(table)
-	} else if (strcasecmp(specifiedType, "SHORT_ARRAY") == 0) {
-		Array value = aidaRequestShortArray(env, uri, arguments);
-		ON_EXCEPTION_RETURN_(table)
-		table = tableCreate(env, value.count, 1);
-		ON_EXCEPTION_RETURN_(table)
-		tableAddColumn(env, &table, AIDA_SHORT_ARRAY_TYPE, value.items, false);
-		ON_EXCEPTION_RETURN_(table)
-	} else if (strcasecmp(specifiedType, "INTEGER_ARRAY") == 0) {
-		Array value = aidaRequestIntegerArray(env, uri, arguments);
-		ON_EXCEPTION_RETURN_(table)
-		table = tableCreate(env, value.count, 1);
-		ON_EXCEPTION_RETURN_(table)
-		tableAddColumn(env, &table, AIDA_INTEGER_ARRAY_TYPE, value.items, false);
-		ON_EXCEPTION_RETURN_(table)
-	} else if (strcasecmp(specifiedType, "LONG_ARRAY") == 0) {
-		Array value = aidaRequestLongArray(env, uri, arguments);
-		ON_EXCEPTION_RETURN_(table)
-		table = tableCreate(env, value.count, 1);
-		ON_EXCEPTION_RETURN_(table)
-		tableAddColumn(env, &table, AIDA_LONG_ARRAY_TYPE, value.items, false);
-		ON_EXCEPTION_RETURN_(table)
-	} else if (strcasecmp(specifiedType, "BOOLEAN_ARRAY") == 0) {
-		Array value = aidaRequestBooleanArray(env, uri, arguments);
-		ON_EXCEPTION_RETURN_(table)
-		table = tableCreate(env, value.count, 1);
-		ON_EXCEPTION_RETURN_(table)
-		tableAddColumn(env, &table, AIDA_BOOLEAN_ARRAY_TYPE, value.items, false);
-		ON_EXCEPTION_RETURN_(table)
+		if (!(*env)->ExceptionCheck(env)) {
+			tableAddSingleRowStringColumn(env, &table, value);
+		}
+		free(value);
+		break;
+	}
 	}
 
 	// Return the table
@@ -696,8 +738,706 @@ void aidaSetValue(JNIEnv* env, const char* uri, Arguments arguments, Value value
 		return;
 	}
 
+	// Cached values of the secondary are no longer valid, even if the set failed part way through
+	invalidateDbCache(slcName);
+
 	FREE_MEMORY
 	if (!SUCCESS(status)) {
 		aidaThrow(env, status, UNABLE_TO_SET_DATA_EXCEPTION, "setting SLC db array device data");
 	}
 }
+
+/**
+ * Get a table of the values of many SLC database PVs in one request.
+ * The `DEVICES` argument lists the PVs, e.g. `["XCOR:LI03:120:LEFF", "KLYS:LI31:31:PDES"]`,
+ * and the optional `TYPES` argument gives the type to read them as, either one type for all the PVs
+ * or one type for each.  They are read as FLOAT if no TYPES are given.
+ *
+ * PVs read as floats or integers are read together, so that the PVs on the same primary and micro
+ * share their database accesses.  The others are read one at a time.  If a `MAXAGE` is given then
+ * the cached value of any PV that is no older than that is returned instead of reading it again.
+ *
+ * If none of the PVs can be read an exception is raised.
+ * Otherwise the following fields are returned:
+ * 		`name`		STRING		PV name
+ * 		`opstat`	BOOLEAN		operation status (true = success, false = failure)
+ * 		`value`		the type the PVs are read as if they are all read as the same type, otherwise STRING
+ * 		`status`	INTEGER		the VMS status of the read of the PV
+ *
+ * @param env to report errors
+ * @param arguments the arguments
+ * @return the table
+ */
+static Table getDbValues(JNIEnv* env, Arguments arguments)
+{
+	TRACK_ALLOCATED_MEMORY
+
+	// Get the arguments
+	char** devices = NULL, ** typeNames = NULL;
+	unsigned int nDevices = 0, nTypeNames = 0;
+	float maxAge = 0.0f;
+	if (ascanf(env, &arguments, "%sa %osa %of",
+			"devices", &devices, &nDevices,
+			"types", &typeNames, &nTypeNames,
+			"maxAge", &maxAge
+	)) {
+		RETURN_NULL_TABLE
+	}
+	TRACK_MEMORY(devices)
+	TRACK_MEMORY(typeNames)
+
+	if (!nDevices) {
+		FREE_MEMORY
+		aidaThrowNonOsException(env, MISSING_REQUIRED_ARGUMENT_EXCEPTION, "No DEVICES were given");
+		RETURN_NULL_TABLE
+	}
+
+	if (nTypeNames > 1 && nTypeNames != nDevices) {
+		FREE_MEMORY
+		aidaThrowNonOsException(env, UNABLE_TO_GET_DATA_EXCEPTION,
+				"TYPES must give one type for all the DEVICES or one type for each of them");
+		RETURN_NULL_TABLE
+	}
+
+	// One block for the values, the names of the PVs read together, the statuses of the PVs and of
+	// the PVs read together, the indexes and values of the PVs read together, and the opstats
+	DbValue* values = ALLOCATE_MEMORY(env, nDevices * (sizeof(DbValue) + sizeof(char*) + 2 * sizeof(vmsstat_t)
+			+ sizeof(int) + sizeof(int4u) + sizeof(bool)), "SLC db values");
+	if (!values) {
+		FREE_MEMORY
+		RETURN_NULL_TABLE
+	}
+	TRACK_MEMORY(values)
+	const char** batchNames = (const char**)(values + nDevices);
+	vmsstat_t* statuses = (vmsstat_t*)(batchNames + nDevices), * batchStatuses = statuses + nDevices;
+	int* batchIndexes = (int*)(batchStatuses + nDevices);
+	int4u* batchWords = (int4u*)(batchIndexes + nDevices);
+	bool* opstats = (bool*)(batchWords + nDevices);
+
+	// Check the PVs and the types to read them as
+	for (int i = 0; i < nDevices; i++) {
+		if (!isDbName(devices[i])) {
+			FREE_MEMORY
+			aidaThrowNonOsException(env, UNABLE_TO_GET_DATA_EXCEPTION,
+					"DEVICES must be given as <primary>:<micro>:<unit>:<secondary>");
+			RETURN_NULL_TABLE
+		}
+
+		memset(&values[i], 0, sizeof(DbValue));
+		values[i].type = nTypeNames ? dbValueType(typeNames[nTypeNames == 1 ? 0 : i]) : AIDA_FLOAT_TYPE;
+		if (values[i].type == AIDA_NO_TYPE) {
+			FREE_MEMORY
+			aidaThrowNonOsException(env, UNABLE_TO_GET_DATA_EXCEPTION,
+					"TYPES must be BOOLEAN, BYTE, SHORT, INTEGER, LONG, FLOAT, DOUBLE, or STRING");
+			RETURN_NULL_TABLE
+		}
+	}
+
+	// Read the PVs read as floats together, then those read as integers, unless their cached values are young enough
+	int nRead = 0;
+	double now = aidaTimeNow();
+	for (int readFloats = 1; readFloats >= 0; readFloats--) {
+		DbRead read = readFloats ? DB_READ_FLOAT : DB_READ_INT;
+		int nBatch = 0;
+		for (int i = 0; i < nDevices; i++) {
+			Type type = values[i].type;
+			if (readFloats ? type == AIDA_FLOAT_TYPE || type == AIDA_DOUBLE_TYPE
+					: type == AIDA_INTEGER_TYPE || type == AIDA_LONG_TYPE || type == AIDA_BOOLEAN_TYPE) {
+				TO_SLC_NAME(devices[i], slcName)
+				if (getCachedDbValue(slcName, read, maxAge, &batchWords[nBatch], now)) {
+					statuses[i] = 1;
+					values[i].number = readFloats ? ((float*)batchWords)[nBatch] : ((int*)batchWords)[nBatch];
+					nRead++;
+					continue;
+				}
+				batchNames[nBatch] = devices[i];
+				batchIndexes[nBatch++] = i;
+			}
+		}
+		if (!nBatch) {
+			continue;
+		}
+
+		if (readFloats) {
+			nRead += JNI_DBGETFLOATS(nBatch, batchNames, (float*)batchWords, batchStatuses);
+		} else {
+			nRead += JNI_DBGETINTS(nBatch, batchNames, (int*)batchWords, batchStatuses);
+		}
+
+		for (int j = 0; j < nBatch; j++) {
+			statuses[batchIndexes[j]] = batchStatuses[j];
+			if (SUCCESS(batchStatuses[j])) {
+				values[batchIndexes[j]].number = readFloats ? ((float*)batchWords)[j] : ((int*)batchWords)[j];
+				if (maxAge > 0.0f) {
+					TO_SLC_NAME(batchNames[j], slcName)
+					cacheDbValue(slcName, read, &batchWords[j], now);
+				}
+			}
+		}
+	}
+
+	// Read the others one at a time
+	for (int i = 0; i < nDevices; i++) {
+		DbValue* value = &values[i];
+		TO_SLC_NAME(devices[i], slcName)
+		if (value->type == AIDA_SHORT_TYPE) {
+			short shortValue = 0;
+			statuses[i] = dbGet(slcName, DB_READ_SHORT, maxAge, &shortValue);
+			value->number = shortValue;
+		} else if (value->type == AIDA_BYTE_TYPE) {
+			unsigned char byteValue = 0;
+			statuses[i] = dbGet(slcName, DB_READ_BYTE, maxAge, &byteValue);
+			value->number = (char)byteValue;
+		} else if (value->type == AIDA_STRING_TYPE) {
+			statuses[i] = dbGet(slcName, DB_READ_STRING, maxAge, &value->string);
+			if (!SUCCESS(statuses[i])) {
+				value->string = NULL;
+			}
+		} else {
+			continue;
+		}
+		if (SUCCESS(statuses[i])) {
+			nRead++;
+		}
+	}
+
+	if (!nRead) {
+		vmsstat_t status = statuses[0];
+		FREE_MEMORY
+		aidaThrow(env, status, UNABLE_TO_GET_DATA_EXCEPTION, "getting SLC db device data");
+		RETURN_NULL_TABLE
+	}
+
+	// The value column is the type the PVs are read as, if they are all read as the same type, otherwise strings
+	int* statusCodes = batchIndexes;
+	Type columnType = values[0].type;
+	for (int i = 0; i < nDevices; i++) {
+		opstats[i] = SUCCESS(statuses[i]);
+		statusCodes[i] = (int)statuses[i];
+		if (values[i].type != columnType) {
+			columnType = AIDA_STRING_TYPE;
+		}
+	}
+
+	// Doubles are the widest value, the same size as strings and longs
+	void* valueData = ALLOCATE_MEMORY(env, nDevices * sizeof(double), "SLC db values");
+	if (!valueData) {
+		for (int i = 0; i < nDevices; i++) {
+			free(values[i].string);
+		}
+		FREE_MEMORY
+		RETURN_NULL_TABLE
+	}
+	TRACK_MEMORY(valueData)
+
+	for (int i = 0; i < nDevices; i++) {
+		double number = values[i].number;
+		switch (columnType) {
+		case AIDA_BOOLEAN_TYPE:
+			((unsigned char*)valueData)[i] = number != 0;
+			break;
+		case AIDA_BYTE_TYPE:
+			((char*)valueData)[i] = (char)number;
+			break;
+		case AIDA_SHORT_TYPE:
+			((short*)valueData)[i] = (short)number;
+			break;
+		case AIDA_INTEGER_TYPE:
+			((int*)valueData)[i] = (int)number;
+			break;
+		case AIDA_LONG_TYPE:
+			((long*)valueData)[i] = (long)number;
+			break;
+		case AIDA_FLOAT_TYPE:
+			((float*)valueData)[i] = (float)number;
+			break;
+		case AIDA_DOUBLE_TYPE:
+			((double*)valueData)[i] = number;
+			break;
+		default:
+			((char**)valueData)[i] = opstats[i] ? dbValueString(&values[i]) : "";
+			break;
+		}
+	}
+
+	Table table = tableCreate(env, (int)nDevices, 4);
+	if (!(*env)->ExceptionCheck(env)) {
+		tableAddStringColumn(env, &table, devices);
+	}
+	if (!(*env)->ExceptionCheck(env)) {
+		tableAddColumn(env, &table, AIDA_BOOLEAN_TYPE, opstats, true);
+	}
+	if (!(*env)->ExceptionCheck(env)) {
+		if (columnType == AIDA_STRING_TYPE) {
+			tableAddStringColumn(env, &table, (char**)valueData);
+		} else {
+			tableAddColumn(env, &table, columnType, valueData, true);
+		}
+	}
+	if (!(*env)->ExceptionCheck(env)) {
+		tableAddColumn(env, &table, AIDA_INTEGER_TYPE, statusCodes, true);
+	}
+
+	for (int i = 0; i < nDevices; i++) {
+		free(values[i].string);
+	}
+	FREE_MEMORY
+	return table;
+}
+
+/**
+ * Check that the given name is an SLC database PV name, <primary>:<micro>:<unit>:<secondary>,
+ * where the unit can be an ASTS channel name
+ *
+ * @param name the name
+ * @return true if it is
+ */
+static bool isDbName(const char* name)
+{
+	const char* micro = strchr(name, ':');
+	if (!micro || micro == name || micro - name > 4) {
+		return false;
+	}
+
+	const char* unit = strchr(micro + 1, ':');
+	if (!unit || unit - micro != 5) {
+		return false;
+	}
+
+	const char* secondary = strchr(unit + 1, ':');
+	if (!secondary || secondary == unit + 1 || secondary - unit > 9) {
+		return false;
+	}
+
+	size_t secondaryLength = strlen(secondary + 1);
+	return secondaryLength && secondaryLength <= 4 && !strchr(secondary + 1, ':');
+}
+
+/**
+ * Get the type to read a PV as from its name in the `TYPES` argument
+ *
+ * @param typeName the name of the type
+ * @return the type, or AIDA_NO_TYPE if it is not a type that PVs can be read as
+ */
+static Type dbValueType(const char* typeName)
+{
+	if (strcasecmp(typeName, "FLOAT") == 0) {
+		return AIDA_FLOAT_TYPE;
+	} else if (strcasecmp(typeName, "DOUBLE") == 0) {
+		return AIDA_DOUBLE_TYPE;
+	} else if (strcasecmp(typeName, "INTEGER") == 0) {
+		return AIDA_INTEGER_TYPE;
+	} else if (strcasecmp(typeName, "LONG") == 0) {
+		return AIDA_LONG_TYPE;
+	} else if (strcasecmp(typeName, "BOOLEAN") == 0) {
+		return AIDA_BOOLEAN_TYPE;
+	} else if (strcasecmp(typeName, "SHORT") == 0) {
+		return AIDA_SHORT_TYPE;
+	} else if (strcasecmp(typeName, "BYTE") == 0) {
+		return AIDA_BYTE_TYPE;
+	} else if (strcasecmp(typeName, "STRING") == 0) {
+		return AIDA_STRING_TYPE;
+	}
+	return AIDA_NO_TYPE;
+}
+
+/**
+ * Get the value of a PV that was read successfully as a string, formatting numbers in the value
+ *
+ * @param value the value
+ * @return the value as a string
+ */
+static char* dbValueString(DbValue* value)
+{
+	switch (value->type) {
+	case AIDA_STRING_TYPE:
+		return value->string ? value->string : "";
+	case AIDA_BOOLEAN_TYPE:
+		return value->number != 0 ? "true" : "false";
+	case AIDA_FLOAT_TYPE:
+	case AIDA_DOUBLE_TYPE:
+		snprintf(value->formatted, DB_VALUE_STRING_LEN, "%.7g", value->number);
+		break;
+	default:
+		snprintf(value->formatted, DB_VALUE_STRING_LEN, "%ld", (long)value->number);
+		break;
+	}
+	return value->formatted;
+}
+
+/**
+ * Get a table of the statistics of the SLC database value cache, with one row and the following fields:
+ * 		`hits`			LONG		requests served from the cache
+ * 		`misses`		LONG		requests giving a MAXAGE that were read from the database
+ * 		`evictions`		LONG		values evicted to make room for others
+ * 		`invalidations`	LONG		values invalidated by setting them
+ * 		`entries`		LONG		values cached
+ * 		`bytes`			LONG		bytes held by the cached values
+ *
+ * @param env to report errors
+ * @return the table
+ */
+static Table getDbCacheStatistics(JNIEnv* env)
+{
+	long statistics[] = { dbCacheStatistics.hits, dbCacheStatistics.misses, dbCacheStatistics.evictions,
+						  dbCacheStatistics.invalidations, dbCacheStatistics.entries, dbCacheStatistics.bytes };
+	int nColumns = sizeof(statistics) / sizeof(statistics[0]);
+
+	Table table = tableCreate(env, 1, nColumns);
+	for (int column = 0; column < nColumns && !(*env)->ExceptionCheck(env); column++) {
+		tableAddSingleRowLongColumn(env, &table, statistics[column]);
+	}
+	return table;
+}
+
+/**
+ * Get an SLC database value, from the value cache if it was cached no more than the given number of seconds ago,
+ * otherwise from the database.  Values read from the database are only cached when a maximum age is given, so
+ * requests that don't use the cache don't pay for copying their values into it.
+ *
+ * Values are returned as they are by the JNI_DBGET routine for the way they are read.  Strings and arrays are
+ * allocated and must be freed by the caller
+ *
+ * @param slcName the SLC name of the value
+ * @param read the way the value is read
+ * @param maxAge the age in seconds of the oldest cached value to return, 0 to always read the database
+ * @param value the value, or a pointer to the allocated value for strings and arrays
+ * @return the status of the read
+ */
+static vmsstat_t dbGet(const char* slcName, DbRead read, float maxAge, void* value)
+{
+	double now = aidaTimeNow();
+	if (getCachedDbValue(slcName, read, maxAge, value, now)) {
+		return 1;
+	}
+
+	vmsstat_t status = dbRead(slcName, read, value);
+	if (SUCCESS(status) && maxAge > 0.0f) {
+		cacheDbValue(slcName, read, value, now);
+	}
+	return status;
+}
+
+/**
+ * Read an SLC database value from the database with the JNI_DBGET routine for the way it is read
+ *
+ * @param slcName the SLC name of the value
+ * @param read the way the value is read
+ * @param value the value, or a pointer to the allocated value for strings and arrays
+ * @return the status of the read
+ */
+static vmsstat_t dbRead(const char* slcName, DbRead read, void* value)
+{
+	switch (read) {
+	case DB_READ_BYTE:
+		return JNI_DBGETBYTE(slcName, (unsigned char*)value);
+	case DB_READ_SHORT:
+		return JNI_DBGETSHORT(slcName, (short*)value);
+	case DB_READ_INT:
+		return JNI_DBGETINT(slcName, (int*)value);
+	case DB_READ_FLOAT:
+		return JNI_DBGETFLOAT(slcName, (float*)value);
+	case DB_READ_STRING:
+		return JNI_DBGETSTRING(slcName, (char**)value);
+	case DB_READ_BYTE_ARRAY:
+		return JNI_DBGETBYTEA(slcName, (unsigned char**)value);
+	case DB_READ_SHORT_ARRAY:
+		return JNI_DBGETSHORTA(slcName, (short**)value);
+	case DB_READ_INT_ARRAY:
+		return JNI_DBGETINTA(slcName, (int**)value);
+	default:
+		return JNI_DBGETFLOATA(slcName, (float**)value);
+	}
+}
+
+/**
+ * Get an SLC database value from the value cache if it was cached no more than the given number of seconds ago.
+ * Strings and arrays are returned in newly allocated memory that the caller must free
+ *
+ * @param slcName the SLC name of the value
+ * @param read the way the value is read
+ * @param maxAge the age in seconds of the oldest cached value to return, 0 to never return a cached value
+ * @param value the value, or a pointer to the allocated value for strings and arrays
+ * @param now the time now
+ * @return true if the value was returned from the cache
+ */
+static bool getCachedDbValue(const char* slcName, DbRead read, float maxAge, void* value, double now)
+{
+	if (maxAge <= 0.0f) {
+		return false;
+	}
+
+	DbCacheEntry* entry = findDbCacheEntry(slcName, read, aidaHash(slcName));
+	if (!entry || now - entry->fetched > maxAge) {
+		dbCacheStatistics.misses++;
+		return false;
+	}
+
+	if (read < DB_READ_STRING) {
+		memcpy(value, entry->data, entry->size);
+	} else {
+		// If there is no memory to copy the value to then just read it afresh
+		void* copy = malloc(entry->size);
+		if (!copy) {
+			dbCacheStatistics.misses++;
+			return false;
+		}
+		memcpy(copy, entry->data, entry->size);
+		*(void**)value = copy;
+	}
+
+	entry->lastUsed = now;
+	dbCacheStatistics.hits++;
+	return true;
+}
+
+/**
+ * Cache an SLC database value just read from the database, in place of any value already cached for it,
+ * or the least recently used value in its set.  Values larger than DB_CACHE_MAX_VALUE_SIZE are not cached
+ *
+ * @param slcName the SLC name of the value
+ * @param read the way the value was read
+ * @param value the value, or a pointer to the allocated value for strings and arrays
+ * @param now the time now
+ */
+static void cacheDbValue(const char* slcName, DbRead read, void* value, double now)
+{
+	if (strlen(slcName) >= MAX_URI_LEN) {
+		return;
+	}
+
+	unsigned int hash = aidaHash(slcName);
+	DbCacheEntry* entry = findDbCacheEntry(slcName, read, hash);
+	if (entry) {
+		releaseDbCacheEntry(entry);
+	}
+
+	size_t size = dbValueSize(read, value);
+	if (size > DB_CACHE_MAX_VALUE_SIZE) {
+		return;
+	}
+
+	// Take the unused or least recently used entry in the value's set
+	if (!entry) {
+		DbCacheEntry* set = &dbCache[(hash & (DB_CACHE_SETS - 1)) * DB_CACHE_WAYS];
+		entry = set;
+		for (int way = 0; way < DB_CACHE_WAYS && entry->fetched; way++) {
+			if (!set[way].fetched || set[way].lastUsed < entry->lastUsed) {
+				entry = &set[way];
+			}
+		}
+		if (entry->fetched) {
+			releaseDbCacheEntry(entry);
+			dbCacheStatistics.evictions++;
+		}
+	}
+
+	if (!(entry->data = malloc(size))) {
+		return;
+	}
+	memcpy(entry->data, read < DB_READ_STRING ? value : *(void**)value, size);
+	entry->hash = hash;
+	entry->read = read;
+	entry->fetched = entry->lastUsed = now;
+	entry->size = size;
+	strcpy(entry->name, slcName);
+
+	dbCacheStatistics.entries++;
+	dbCacheStatistics.bytes += (long)size;
+}
+
+/**
+ * Invalidate all the cached values of an SLC database secondary, however they were read
+ *
+ * @param slcName the SLC name of the secondary
+ */
+static void invalidateDbCache(const char* slcName)
+{
+	unsigned int hash = aidaHash(slcName);
+	DbCacheEntry* set = &dbCache[(hash & (DB_CACHE_SETS - 1)) * DB_CACHE_WAYS];
+	for (int way = 0; way < DB_CACHE_WAYS; way++) {
+		DbCacheEntry* entry = &set[way];
+		if (entry->fetched && entry->hash == hash && strcmp(entry->name, slcName) == 0) {
+			releaseDbCacheEntry(entry);
+			dbCacheStatistics.invalidations++;
+		}
+	}
+}
+
+/**
+ * Find the cached value of an SLC database value read the given way
+ *
+ * @param slcName the SLC name of the value
+ * @param read the way the value was read
+ * @param hash the hash of the SLC name
+ * @return the cache entry, or NULL if the value is not cached
+ */
+static DbCacheEntry* findDbCacheEntry(const char* slcName, DbRead read, unsigned int hash)
+{
+	DbCacheEntry* set = &dbCache[(hash & (DB_CACHE_SETS - 1)) * DB_CACHE_WAYS];
+	for (int way = 0; way < DB_CACHE_WAYS; way++) {
+		DbCacheEntry* entry = &set[way];
+		if (entry->fetched && entry->hash == hash && entry->read == read && strcmp(entry->name, slcName) == 0) {
+			return entry;
+		}
+	}
+	return NULL;
+}
+
+/**
+ * Release a cache entry and its value
+ *
+ * @param entry the cache entry
+ */
+static void releaseDbCacheEntry(DbCacheEntry* entry)
+{
+	dbCacheStatistics.entries--;
+	dbCacheStatistics.bytes -= (long)entry->size;
+	free(entry->data);
+	entry->data = NULL;
+	entry->fetched = 0.0;
+}
+
+/**
+ * Get the size of an SLC database value as it is returned by the JNI_DBGET routine for the way it is read.
+ * Arrays start with the number of elements, as their first element
+ *
+ * @param read the way the value was read
+ * @param value the value, or a pointer to the allocated value for strings and arrays
+ * @return the size of the value
+ */
+static size_t dbValueSize(DbRead read, void* value)
+{
+	switch (read) {
+	case DB_READ_BYTE:
+		return sizeof(unsigned char);
+	case DB_READ_SHORT:
+		return sizeof(short);
+	case DB_READ_INT:
+		return sizeof(int);
+	case DB_READ_FLOAT:
+		return sizeof(float);
+	case DB_READ_STRING:
+	case DB_READ_BYTE_ARRAY:
+		return strlen(*(char**)value) + 1;
+	case DB_READ_SHORT_ARRAY:
+		return (**(short**)value + 1) * sizeof(short);
+	case DB_READ_INT_ARRAY:
+		return (**(int**)value + 1) * sizeof(int);
+	default:
+		return ((int)**(float**)value + 1) * sizeof(float);
+	}
+}
+
+/**
+ * Get a table with one column containing an SLC database array value.  The value is read into a buffer
+ * allocated by the JNI_DBGET routine, or copied out of the value cache, and is also copied into the cache when a
+ * `MAXAGE` is given.  The values are then unpacked, and converted if need be, straight from that buffer into the
+ * table column, without an intermediate array
+ *
+ * @param env to be used to throw exceptions using aidaThrow() and aidaThrowNonOsException()
+ * @param slcName the SLC name of the value
+ * @param tableType the type of the table column
+ * @param maxAge the age in seconds of the oldest cached value to return, 0 to always read the database
+ * @return the table
+ */
+static Table getDbArrayTable(JNIEnv* env, const char* slcName, const DbTableType* tableType, float maxAge)
+{
+	void* items = NULL;
+	vmsstat_t status = dbGet(slcName, tableType->read, maxAge, &items);
+	if (!SUCCESS(status)) {
+		aidaThrow(env, status, UNABLE_TO_GET_DATA_EXCEPTION, "getting SLC db array device data");
+		RETURN_NULL_TABLE
+	}
+
+	// The first item is the count, except for byte arrays that are read as strings
+	int count;
+	switch (tableType->read) {
+	case DB_READ_BYTE_ARRAY:
+		count = (int)strlen((char*)items);
+		break;
+	case DB_READ_SHORT_ARRAY:
+		count = *(short*)items;
+		break;
+	case DB_READ_INT_ARRAY:
+		count = *(int*)items;
+		break;
+	default:
+		count = (int)*(float*)items;
+		break;
+	}
+
+	Table table = tableCreate(env, count, 1);
+	void* column = (*env)->ExceptionCheck(env) ? NULL : tableAddEmptyColumn(env, &table, tableType->type);
+	if (!column) {
+		free(items);
+		return table;
+	}
+
+	int* ints = (int*)items + 1;
+	float* floats = (float*)items + 1;
+	switch (tableType->type) {
+	case AIDA_BOOLEAN_ARRAY_TYPE:
+		for (int i = 0; i < count; i++) {
+			((unsigned char*)column)[i] = ints[i] != 0;
+		}
+		break;
+	case AIDA_BYTE_ARRAY_TYPE:
+		memcpy(column, items, count);
+		break;
+	case AIDA_SHORT_ARRAY_TYPE:
+		memcpy(column, (short*)items + 1, count * sizeof(short));
+		break;
+	case AIDA_INTEGER_ARRAY_TYPE:
+		memcpy(column, ints, count * sizeof(int));
+		break;
+	case AIDA_LONG_ARRAY_TYPE:
+		for (int i = 0; i < count; i++) {
+			((long*)column)[i] = ints[i];
+		}
+		break;
+	case AIDA_FLOAT_ARRAY_TYPE:
+		memcpy(column, floats, count * sizeof(float));
+		break;
+	default:
+		for (int i = 0; i < count; i++) {
+			((double*)column)[i] = floats[i];
+		}
+		break;
+	}
+
+	free(items);
+	return table;
+}
+
+/**
+ * Find a `TABLE_TYPE` by name, ignoring case.  The hash of the upper cased name is looked up by a binary search
+ * of the types, which are sorted by the precomputed hashes of their names, so the name is only compared with the
+ * one type it is likely to be
+ *
+ * @param typeName the name of the type
+ * @return the type, or NULL if it is not a type that SLC database values can be returned as
+ */
+static const DbTableType* dbTableType(const char* typeName)
+{
+	char upperName[DB_TABLE_TYPE_NAME_MAX + 1];
+	if (strlen(typeName) > DB_TABLE_TYPE_NAME_MAX) {
+		return NULL;
+	}
+	for (int i = 0; (upperName[i] = (char)toupper((unsigned char)typeName[i])); i++);
+
+	unsigned int hash = aidaHash(upperName);
+	int low = 0, high = (int)(sizeof(dbTableTypes) / sizeof(dbTableTypes[0])) - 1;
+	while (low <= high) {
+		int middle = (low + high) / 2;
+		const DbTableType* tableType = &dbTableTypes[middle];
+		if (tableType->hash < hash) {
+			low = middle + 1;
+		} else if (tableType->hash > hash) {
+			high = middle - 1;
+		} else {
+			return strcmp(tableType->name, upperName) == 0 ? tableType : NULL;
+		}
+	}
+	return NULL;
+}
@@ -22,6 +22,9 @@ extern vmsstat_t JNI_DBGETSHORTA(const char*, short int**);
 extern vmsstat_t JNI_DBGETINTA(const char*, int**);
 extern vmsstat_t JNI_DBGETFLOATA(const char*, float**);
 
+extern int JNI_DBGETFLOATS(int, const char**, float*, vmsstat_t*);
+extern int JNI_DBGETINTS(int, const char**, int*, vmsstat_t*);
+
 extern int JNI_DBACCESSENABLED(void);
 
 extern vmsstat_t JNI_DBSETFLOAT(const char*, float*, int length);
@@ -32,6 +35,113 @@ extern vmsstat_t JNI_DBSETINT(const char*, int*, int length);
 #define FLAG_SUBSTRING 1
 #define TOTAL_PSEUDO_SECONDARY_LEN (TEXT_SUBSTRING+COLOR_SUBSTRING+FLAG_SUBSTRING + 2)
 
+/**
+ * The number of sets in the SLC database value cache.  Must be a power of two
+ */
+#define DB_CACHE_SETS 256
+
+/**
+ * The number of entries in each set of the SLC database value cache.
+ * The least recently used entry in a set is evicted when a new value is cached
+ */
+#define DB_CACHE_WAYS 4
+
+/**
+ * The largest value kept in the SLC database value cache, in bytes.  Larger values are always read afresh.
+ * With DB_CACHE_SETS and DB_CACHE_WAYS this bounds the memory held by the cache
+ */
+#define DB_CACHE_MAX_VALUE_SIZE 1024
+
+/**
+ * Get the optional `MAXAGE` argument, the age in seconds of the oldest cached value the request will accept,
+ * into a float variable of the given name.  Returns the given value if the argument is not valid
+ *
+ * @param _var the name of the variable to store the maximum age in, 0 if no `MAXAGE` is given
+ * @param _r the value to return if the argument is not valid
+ */
+#define GET_MAX_AGE_OR_RETURN_(_var, _r) \
+    float _var = 0.0f; \
+    if (ascanf(env, &arguments, "%of", "maxAge", &_var)) { \
+        return _r; \
+    }
+
+/**
+ * The ways an SLC database value can be read, one for each of the JNI_DBGET routines used.
+ * Values are cached separately for each way they are read
+ */
+typedef enum
+{
+	DB_READ_BYTE,
+	DB_READ_SHORT,
+	DB_READ_INT,
+	DB_READ_FLOAT,
+	DB_READ_STRING,
+	DB_READ_BYTE_ARRAY,
+	DB_READ_SHORT_ARRAY,
+	DB_READ_INT_ARRAY,
+	DB_READ_FLOAT_ARRAY
+} DbRead;
+
+/**
+ * An SLC database value in the value cache, as it was returned by its JNI_DBGET routine
+ */
+typedef struct
+{
+	unsigned int hash;             ///< hash of the name, used to find its set
+	DbRead read;                   ///< the way the value was read
+	double fetched;                ///< the time the value was read from the database, 0 for an unused entry
+	double lastUsed;               ///< the time the value was last cached or served
+	size_t size;                   ///< the size of the value
+	void* data;                    ///< the value
+	char name[MAX_URI_LEN];        ///< the SLC name of the value
+} DbCacheEntry;
+
+/**
+ * The statistics of the SLC database value cache
+ */
+typedef struct
+{
+	long hits;                     ///< requests served from the cache
+	long misses;                   ///< requests giving a MAXAGE that were read from the database
+	long evictions;                ///< values evicted to make room for others
+	long invalidations;            ///< values invalidated by setting them
+	long entries;                  ///< values cached
+	long bytes;                    ///< bytes held by the cached values
+} DbCacheStatistics;
+
+/**
+ * The length of the longest `TABLE_TYPE` name that an SLC database value can be returned as
+ */
+#define DB_TABLE_TYPE_NAME_MAX 13
+
+/**
+ * A `TABLE_TYPE` that an SLC database value can be returned as, with the hash of its name so that the
+ * `TABLE_TYPE` argument can be found without comparing it to every name
+ */
+typedef struct
+{
+	const char* name;              ///< the name of the type, as given in `TABLE_TYPE`
+	unsigned int hash;             ///< the aidaHash() of the name
+	Type type;                     ///< the type of the table column
+	DbRead read;                   ///< the way the value is read
+} DbTableType;
+
+/**
+ * The longest formatted value returned in the string value column of a multi-PV get
+ */
+#define DB_VALUE_STRING_LEN 32
+
+/**
+ * The value of one PV of a multi-PV get
+ */
+typedef struct
+{
+	Type type;                                ///< the type the PV is read as
+	double number;                            ///< the value of a PV read as a number
+	char* string;                             ///< the value of a PV read as a string
+	char formatted[DB_VALUE_STRING_LEN + 1];  ///< the value of a PV read as a number, formatted as a string
+} DbValue;
+
 #ifdef __cplusplus
 }
 #endif
@@ -8,7 +8,6 @@
 
 static int getKlystronStatus(JNIEnv* env, const char* uri, Arguments arguments, short* klys_status);
 static int klystronStatus(JNIEnv* env, char slcName[30], char* beam_c, char* dgrp_c, short* klys_status);
-static int klystronStatusDontThrow(JNIEnv* env, char slcName[30], char* beam_c, char* dgrp_c, short* klys_status);
 static int
 klystronStatusImpl(JNIEnv* env, char slcName[30], char* beam_c, char* dgrp_c, short* klys_status, bool onErrorThrow);
 static Table setActivateValue(JNIEnv* env, const char* uri, Arguments arguments, Value value);
@@ -21,19 +20,17 @@ static Table setPdesOrKphrValue(JNIEnv* env, const char* uri, Arguments argument
 static void setPconOrAconValue(JNIEnv* env, Arguments arguments, Value value, char* pmu, char* secn);
 static int getStandardArgs(JNIEnv* env, Arguments arguments, char** beam_c, char** dgrp_c);
 static int getDeviceList(JNIEnv* env, const char* uri, Arguments arguments, char*** devices, int* nDevices);
-static bool getKlystronStatuses(JNIEnv* env, char* const* devices, int nDevices,
-		char* beam_c, char* dgrp_c,
-		short* status,
-		bool* isSuccessFull,
-		bool* isInAccelerateState,
-		bool* isInStandByState,
-		bool* isInBadState,
-		bool* isSledTuned,
-		bool* isSleded,
-		bool* isPampl,
-		bool* isPphas);
+static bool getKlystronStatuses(JNIEnv* env, Table* table, char* const* devices, int nDevices,
+		char* beam_c, char* dgrp_c, float maxAge, bool raw);
+static bool getSnapshotKlystronStatuses(JNIEnv* env, char* const* devices, int nDevices, char* beam_c, char* dgrp_c,
+		float maxAge, short* statuses, vmsstat_t* queryStatuses);
+static KlystronStatusSnapshot* findKlystronStatusSnapshot(int beam, const char* dgrp, double now);
+static KlystronStatus* findKlystronStatus(KlystronStatusSnapshot* snapshot, const char* name);
+static short* findKlystronStatusSlot(KlystronStatusSnapshot* snapshot, const char* name, unsigned int hash);
+static void removeKlystronStatusSlot(KlystronStatusSnapshot* snapshot, short entry);
 static void simpleSetValue(JNIEnv* env, const char* uri, Arguments arguments, Value value);
 static void multiSetValue(JNIEnv* env, const char* uri, Arguments arguments, Value value);
+static Table multiSetPdesOrKphrValue(JNIEnv* env, const char* uri, Arguments arguments, Value value);
 static int getKlystronMultiSetArguments(JNIEnv* env, const char* uri, Arguments arguments, Value value,
 		int* count, char** prim_list,
 		char** micr_list, int** unit_list, int4u* secn, float** set_values, char** name_validity);
@@ -50,6 +47,9 @@ static void getInvalidNames(char* dst, int count, char* names[], const char* nam
  */
 #define STD_ATTRIBUTE_LEN strlen(STD_ATTRIBUTE)
 
+// Latest status snapshots for table requests that give a MAXAGE
+static KlystronStatusSnapshot klystronStatusSnapshots[MAX_KLYS_STATUS_SNAPSHOTS];
+
 // API Stubs
 VERSION("1.0.0")
 REQUEST_STUB_BOOLEAN
@@ -159,6 +159,13 @@ char* aidaRequestString(JNIEnv* env, const char* uri, Arguments arguments)
  * 		`sleded`	BOOLEAN		true if sleded
  * 		`pampl`		BOOLEAN		true if pampl
  * 		`pphas`		BOOLEAN		true if pphas
+ *
+ * If `RAW` is true then only the `name`, `opstat`, and `status` columns are returned, and the label of the
+ * `status` column gives the decoding of its bits.
+ *
+ * If a `MAXAGE` is given then the status of each klystron is served from the latest status obtained for it on the
+ * same beam code and display group, if it is no older than `MAXAGE` seconds.  The statuses that are older, or have
+ * not been obtained yet, are all refreshed together.
  */
 Table aidaRequestTable(JNIEnv* env, const char* uri, Arguments arguments)
 {
@@ -187,130 +194,321 @@ Table aidaRequestTable(JNIEnv* env, const char* uri, Arguments arguments)
     TRACK_MEMORY(beam_c)
     TRACK_MEMORY(dgrp_c)
 
-    // Query results variables
-    short status[nDevices];
-    bool isSuccessFull[nDevices];
-    bool isInAccelerateState[nDevices];
-    bool isInStandByState[nDevices];
-    bool isInBadState[nDevices];
-    bool isSledTuned[nDevices];
-    bool isSleded[nDevices];
-    bool isPampl[nDevices];
-    bool isPphas[nDevices];
-
-    // Get the status for each klystron into the query results variables
-    if (getKlystronStatuses(env, devices, nDevices, beam_c, dgrp_c,
-            status, isSuccessFull, isInAccelerateState,
-            isInStandByState, isInBadState, isSledTuned, isSleded, isPampl, isPphas)) {
-        // Queries have failed for all klystron devices so raise an error
-        aidaThrowNonOsException(env, UNABLE_TO_GET_DATA_EXCEPTION, "Failed to get any Klystron Device Statuses");
+    // Get the optional arguments
+    float maxAge = 0.0f;
+    unsigned char raw = 0;
+    if (ascanf(env, &arguments, "%of %ob",
+            "maxAge", &maxAge,
+            "raw", &raw
+    )) {
+        ON_EXCEPTION_FREE_MEMORY_AND_RETURN_(table)
+    }
+
+    if (maxAge < 0.0f) {
         FREE_MEMORY
+        aidaThrowNonOsException(env, UNABLE_TO_GET_DATA_EXCEPTION, "MAXAGE argument out of range");
         return table;
     }
 
-    // Free up standard args (don't need them anymore)
-    FREE_TRACKED_MEMORY(beam_c);
-    FREE_TRACKED_MEMORY(dgrp_c);
-
-    // Allocate a table of 10 columns
-    table = tableCreate(env, nDevices, 10);
+    // Allocate a streaming table of 10 columns, or 3 if raw, one row is added per klystron
+    Type types[] = { AIDA_STRING_TYPE, AIDA_BOOLEAN_TYPE, AIDA_SHORT_TYPE, AIDA_BOOLEAN_TYPE, AIDA_BOOLEAN_TYPE,
+                     AIDA_BOOLEAN_TYPE, AIDA_BOOLEAN_TYPE, AIDA_BOOLEAN_TYPE, AIDA_BOOLEAN_TYPE, AIDA_BOOLEAN_TYPE };
+    table = tableCreateStreaming(env, raw ? 3 : 10, types);
     ON_EXCEPTION_FREE_MEMORY_AND_RETURN_(table)
 
-    // Add the klystron names as the first column
-    tableAddStringColumn(env, &table, devices);
+    // A raw table has its own fields, with the decoding of the status bits in the label of the status column
+    if (raw) {
+        char* fields[] = { "name", "opstat", "status" };
+        char* labels[] = { "Device Name", "Operation Status", KLYS_STATUS_DECODE };
+        for (int column = 0; column < 3 && !(*env)->ExceptionCheck(env); column++) {
+            tableAddField(env, &table, fields[column]);
+            if (!(*env)->ExceptionCheck(env)) {
+                tableAddLabel(env, &table, labels[column]);
+            }
+        }
+        ON_EXCEPTION_FREE_MEMORY_AND_RETURN_(table)
+    }
+
+    // Get the status for each klystron into the table
+    bool allFail = getKlystronStatuses(env, &table, devices, nDevices, beam_c, dgrp_c, maxAge, raw);
     ON_EXCEPTION_FREE_MEMORY_AND_RETURN_(table)
 
     // Free all allocated memory
     FREE_MEMORY
 
-    // Add remaining columns to table
-    tableAddColumn(env, &table, AIDA_BOOLEAN_TYPE, &isSuccessFull, false);
-    ON_EXCEPTION_RETURN_(table)
-    tableAddColumn(env, &table, AIDA_SHORT_TYPE, &status, false);
-    ON_EXCEPTION_RETURN_(table)
-    tableAddColumn(env, &table, AIDA_BOOLEAN_TYPE, &isInAccelerateState, false);
-    ON_EXCEPTION_RETURN_(table)
-    tableAddColumn(env, &table, AIDA_BOOLEAN_TYPE, &isInStandByState, false);
-    ON_EXCEPTION_RETURN_(table)
-    tableAddColumn(env, &table, AIDA_BOOLEAN_TYPE, &isInBadState, false);
-    ON_EXCEPTION_RETURN_(table)
-    tableAddColumn(env, &table, AIDA_BOOLEAN_TYPE, &isSledTuned, false);
-    ON_EXCEPTION_RETURN_(table)
-    tableAddColumn(env, &table, AIDA_BOOLEAN_TYPE, &isSleded, false);
-    ON_EXCEPTION_RETURN_(table)
-    tableAddColumn(env, &table, AIDA_BOOLEAN_TYPE, &isPampl, false);
-    ON_EXCEPTION_RETURN_(table)
-    tableAddColumn(env, &table, AIDA_BOOLEAN_TYPE, &isPphas, false);
+    if (allFail) {
+        // Queries have failed for all klystron devices so raise an error
+        releaseTable(table);
+        table.columnCount = 0;
+        aidaThrowNonOsException(env, UNABLE_TO_GET_DATA_EXCEPTION, "Failed to get any Klystron Device Statuses");
+    }
 
     return table;
 }
 
 /**
- * Get status for each of the given list of klystrons and return status in the given arrays
+ * Get status for each of the given list of klystrons and append a row for each to the given table.
+ * The status of all the klystrons is obtained in one batch, with the beam code and display group
+ * only converted once, and the rows are then appended to the table as a single chunk
  * @param env
+ * @param table the streaming table to append the name, query success status, status code,
+ * and, unless raw, each of the status flags, to
  * @param devices names of klystron devices to query
  * @param nDevices the number of devices
  * @param beam_c the beam code
  * @param dgrp_c the dgroup
- * @param status the pre-allocated space for the status code
- * @param isSuccessFull the pre-allocated space for the query success status
- * @param isInAccelerateState the pre-allocated space for the is In Accelerate state
- * @param isInStandByState the pre-allocated space for the is in standby state
- * @param isInBadState the pre-allocated space for the is in bad state
- * @param isSledTuned the pre-allocated space for the is sled tuned
- * @param isSleded the pre-allocated space for the  is sledded state
- * @param isPampl the pre-allocated space for the is pampl
- * @param isPphas the pre-allocated space for the is pphas
+ * @param maxAge the maximum age, in seconds, of a status that can be returned, or 0 to always get new statuses
+ * @param raw true to append only the name, query success status, and status code
  * @return true if all of the attempts to get status fail, otherwise false
  */
-static bool getKlystronStatuses(JNIEnv* env, char* const* devices, int nDevices,
-		char* beam_c, char* dgrp_c,
-		short* status,
-		bool* isSuccessFull,
-		bool* isInAccelerateState,
-		bool* isInStandByState,
-		bool* isInBadState,
-		bool* isSledTuned,
-		bool* isSleded,
-		bool* isPampl,
-		bool* isPphas)
+static bool getKlystronStatuses(JNIEnv* env, Table* table, char* const* devices, int nDevices,
+		char* beam_c, char* dgrp_c, float maxAge, bool raw)
 {
-	bool allFail = true;
+	short statusFlags[] = { LINKLYSTA_ACCEL, LINKLYSTA_STANDBY, LINKLYSTA_BAD, LINKLYSTA_SLED_TUNED, LINKLYSTA_SLEDED,
+							LINKLYSTA_PAMPL, LINKLYSTA_PPHAS };
+	int nFlags = sizeof(statusFlags) / sizeof(short);
+
+	// One block for the query status and status code of each klystron, and the columns of success and status flags
+	vmsstat_t* queryStatuses = ALLOCATE_MEMORY(env,
+			nDevices * (sizeof(vmsstat_t) + sizeof(short) + (1 + nFlags) * sizeof(bool)), "klystron statuses");
+	if (!queryStatuses) {
+		return true;
+	}
+	short* statuses = (short*)(queryStatuses + nDevices);
+	bool* successData = (bool*)(statuses + nDevices);
+
+	// Get the status of all the klystron devices at once, the device names are in primary:micro:unit form already
+	if (maxAge > 0.0f) {
+		if (!getSnapshotKlystronStatuses(env, devices, nDevices, beam_c, dgrp_c ? dgrp_c : "LIN_KLYS", maxAge,
+				statuses, queryStatuses)) {
+			free(queryStatuses);
+			return true;
+		}
+	} else {
+		DPSLCKLYS_GETSTATUSES(nDevices, (char**)devices, beam_c, dgrp_c ? dgrp_c : "LIN_KLYS", statuses,
+				queryStatuses);
+	}
 
-	// For each klystron device, get the status
+	// Set the query success and, unless raw, each status flag of each klystron
+	bool allFail = true;
 	for (int i = 0; i < nDevices; i++) {
-		char device[strlen(devices[i]) + STD_ATTRIBUTE_LEN + 1];
-		sprintf(device, "%s%s", devices[i], STD_ATTRIBUTE);
-
-		TO_SLC_NAME(device, slcName)
-
-		if (!klystronStatusDontThrow(env, slcName, beam_c, dgrp_c, &status[i])) {
-			allFail = false; // At least one has not failed
-
-			// Successful status query
-			isSuccessFull[i] = true;
-			isInAccelerateState[i] = (short)(status[i] & LINKLYSTA_ACCEL) ? true : false;
-			isInStandByState[i] = (short)(status[i] & LINKLYSTA_STANDBY) ? true : false;
-			isInBadState[i] = (short)(status[i] & LINKLYSTA_BAD) ? true : false;
-			isSledTuned[i] = (short)(status[i] & LINKLYSTA_SLED_TUNED) ? true : false;
-			isSleded[i] = (short)(status[i] & LINKLYSTA_SLEDED) ? true : false;
-			isPampl[i] = (short)(status[i] & LINKLYSTA_PAMPL) ? true : false;
-			isPphas[i] = (short)(status[i] & LINKLYSTA_PPHAS) ? true : false;
+		successData[i] = SUCCESS(queryStatuses[i]) ? true : false;
+		if (successData[i]) {
+			allFail = false;      // At least one has not failed
 		} else {
-			// Unsuccessful status query
-			isSuccessFull[i] = false;
-			isInAccelerateState[i] = false;
-			isInStandByState[i] = false;
-			isInBadState[i] = false;
-			isSledTuned[i] = false;
-			isSleded[i] = false;
-			isPampl[i] = false;
-			isPphas[i] = false;
+			statuses[i] = 0;      // Unsuccessful status query so no flags are set
+		}
+		for (int flag = 0; flag < nFlags && !raw; flag++) {
+			successData[(flag + 1) * nDevices + i] = (short)(statuses[i] & statusFlags[flag]) ? true : false;
 		}
 	}
+
+	// Append a row for each klystron, in the order given
+	void* data[] = { (void*)devices, successData, statuses, successData + nDevices, successData + 2 * nDevices,
+					 successData + 3 * nDevices, successData + 4 * nDevices, successData + 5 * nDevices,
+					 successData + 6 * nDevices, successData + 7 * nDevices };
+	tableAppendChunk(env, table, nDevices, data, true);
+
+	free(queryStatuses);
 	return allFail;
 }
 
+/**
+ * Get the status of each of the given klystrons from the snapshot for the given beam code and display group.
+ * Statuses in the snapshot that are no older than maxAge seconds are used as they are, and all the others
+ * are obtained together in one batch, and kept in the snapshot for subsequent requests.
+ * Only successfully obtained statuses are kept so failed ones are always retried
+ *
+ * @param env to be used to throw exceptions using aidaThrow() and aidaThrowNonOsException()
+ * @param devices names of klystron devices to query
+ * @param nDevices the number of devices
+ * @param beam_c the beam code
+ * @param dgrp_c the dgroup
+ * @param maxAge the maximum age, in seconds, of a status that can be returned
+ * @param statuses the status code of each klystron, set on return
+ * @param queryStatuses the query status of each klystron, set on return
+ * @return true unless an exception has been raised
+ */
+static bool getSnapshotKlystronStatuses(JNIEnv* env, char* const* devices, int nDevices, char* beam_c, char* dgrp_c,
+		float maxAge, short* statuses, vmsstat_t* queryStatuses)
+{
+	// One block for the name, row, query status and status code of each stale klystron
+	char** staleDevices = ALLOCATE_MEMORY(env,
+			nDevices * (sizeof(char*) + sizeof(int) + sizeof(vmsstat_t) + sizeof(short)), "klystron statuses");
+	if (!staleDevices) {
+		return false;
+	}
+	int* staleRows = (int*)(staleDevices + nDevices);
+	vmsstat_t* staleQueryStatuses = (vmsstat_t*)(staleRows + nDevices);
+	short* staleStatuses = (short*)(staleQueryStatuses + nDevices);
+	int nStale = 0;
+
+	double now = aidaTimeNow();
+	KlystronStatusSnapshot* snapshot = findKlystronStatusSnapshot(atoi(beam_c), dgrp_c, now);
+	snapshot->lastRequested = now;
+
+	// Use the statuses that are fresh enough, and list the rest to be refreshed
+	for (int i = 0; i < nDevices; i++) {
+		KlystronStatus* klystronStatus = findKlystronStatus(snapshot, devices[i]);
+		if (klystronStatus && now - klystronStatus->acquired <= maxAge) {
+			statuses[i] = klystronStatus->status;
+			queryStatuses[i] = 1;
+		} else {
+			staleDevices[nStale] = devices[i];
+			staleRows[nStale++] = i;
+		}
+	}
+
+	if (!nStale) {
+		free(staleDevices);
+		return true;
+	}
+
+	// Refresh the stale statuses together
+	DPSLCKLYS_GETSTATUSES(nStale, staleDevices, beam_c, dgrp_c, staleStatuses, staleQueryStatuses);
+
+	for (int i = 0; i < nStale; i++) {
+		short status = staleStatuses[i];
+		vmsstat_t queryStatus = staleQueryStatuses[i];
+		statuses[staleRows[i]] = status;
+		queryStatuses[staleRows[i]] = queryStatus;
+
+		// Keep the new status in the snapshot, replacing the oldest one if it is full
+		if (!SUCCESS(queryStatus) || strlen(staleDevices[i]) >= KLYS_STATUS_NAME_LEN) {
+			continue;
+		}
+		unsigned int hash = aidaHash(staleDevices[i]);
+		short* slot = findKlystronStatusSlot(snapshot, staleDevices[i], hash);
+		if (*slot < 0) {
+			short entry = 0;
+			if (snapshot->count < MAX_KLYS_SNAPSHOT_DEVICES) {
+				entry = (short)snapshot->count++;
+			} else {
+				for (short j = 1; j < snapshot->count; j++) {
+					if (snapshot->statuses[j].acquired < snapshot->statuses[entry].acquired) {
+						entry = j;
+					}
+				}
+				// Removing the oldest from the index can move the slot the new one belongs in
+				removeKlystronStatusSlot(snapshot, entry);
+				slot = findKlystronStatusSlot(snapshot, staleDevices[i], hash);
+			}
+			strcpy(snapshot->statuses[entry].name, staleDevices[i]);
+			snapshot->statuses[entry].hash = hash;
+			*slot = entry;
+		}
+		snapshot->statuses[*slot].status = status;
+		snapshot->statuses[*slot].acquired = now;
+	}
+
+	free(staleDevices);
+	return true;
+}
+
+/**
+ * Find the status snapshot for the given beam code and display group, releasing any idle snapshots on the way.
+ * If there is none then a free snapshot is taken for it, or the least recently requested one if none are free
+ *
+ * @param beam the beam code
+ * @param dgrp the display group
+ * @param now the time now, in seconds
+ * @return the snapshot
+ */
+static KlystronStatusSnapshot* findKlystronStatusSnapshot(int beam, const char* dgrp, double now)
+{
+	KlystronStatusSnapshot* found = NULL, * freeSnapshot = NULL, * oldest = NULL;
+
+	for (int i = 0; i < MAX_KLYS_STATUS_SNAPSHOTS; i++) {
+		KlystronStatusSnapshot* snapshot = &klystronStatusSnapshots[i];
+		if (snapshot->lastRequested != 0.0 && now - snapshot->lastRequested > KLYS_STATUS_SNAPSHOT_IDLE_EXPIRY) {
+			snapshot->lastRequested = 0.0;
+		}
+
+		if (snapshot->lastRequested == 0.0) {
+			if (!freeSnapshot) {
+				freeSnapshot = snapshot;
+			}
+		} else if (snapshot->beam == beam && strncmp(snapshot->dgrp, dgrp, KLYS_STATUS_DGRP_LEN) == 0) {
+			found = snapshot;
+		} else if (!oldest || snapshot->lastRequested < oldest->lastRequested) {
+			oldest = snapshot;
+		}
+	}
+
+	if (found) {
+		return found;
+	}
+
+	if (!freeSnapshot) {
+		freeSnapshot = oldest;
+	}
+	freeSnapshot->beam = beam;
+	strncpy(freeSnapshot->dgrp, dgrp, KLYS_STATUS_DGRP_LEN);
+	freeSnapshot->dgrp[KLYS_STATUS_DGRP_LEN] = 0x0;
+	freeSnapshot->count = 0;
+	memset(freeSnapshot->index, 0xff, sizeof(freeSnapshot->index));
+	return freeSnapshot;
+}
+
+/**
+ * Find the status of the named klystron in the given snapshot
+ *
+ * @param snapshot the snapshot
+ * @param name the klystron name
+ * @return the status or NULL if it is not in the snapshot
+ */
+static KlystronStatus* findKlystronStatus(KlystronStatusSnapshot* snapshot, const char* name)
+{
+	short entry = *findKlystronStatusSlot(snapshot, name, aidaHash(name));
+	return entry < 0 ? NULL : &snapshot->statuses[entry];
+}
+
+/**
+ * Find the slot in the given snapshot's index for the named klystron.  This is the slot of its status if it is
+ * in the snapshot, otherwise the unused slot it would be added in.  There is always an unused slot as the index
+ * has more slots than a snapshot has statuses
+ *
+ * @param snapshot the snapshot
+ * @param name the klystron name
+ * @param hash the aidaHash() of the name
+ * @return the slot
+ */
+static short* findKlystronStatusSlot(KlystronStatusSnapshot* snapshot, const char* name, unsigned int hash)
+{
+	for (unsigned int slot = hash & KLYS_SNAPSHOT_INDEX_MASK;; slot = (slot + 1) & KLYS_SNAPSHOT_INDEX_MASK) {
+		short entry = snapshot->index[slot];
+		if (entry < 0
+				|| (snapshot->statuses[entry].hash == hash && strcmp(snapshot->statuses[entry].name, name) == 0)) {
+			return &snapshot->index[slot];
+		}
+	}
+}
+
+/**
+ * Remove the given status from the given snapshot's index, moving back any statuses after it in the same run of
+ * used slots that would otherwise no longer be found from the slot of their hash
+ *
+ * @param snapshot the snapshot
+ * @param entry the status to remove
+ */
+static void removeKlystronStatusSlot(KlystronStatusSnapshot* snapshot, short entry)
+{
+	unsigned int slot = snapshot->statuses[entry].hash & KLYS_SNAPSHOT_INDEX_MASK;
+	while (snapshot->index[slot] != entry) {
+		slot = (slot + 1) & KLYS_SNAPSHOT_INDEX_MASK;
+	}
+
+	for (unsigned int next = (slot + 1) & KLYS_SNAPSHOT_INDEX_MASK; snapshot->index[next] >= 0;
+		 next = (next + 1) & KLYS_SNAPSHOT_INDEX_MASK) {
+		unsigned int home = snapshot->statuses[snapshot->index[next]].hash & KLYS_SNAPSHOT_INDEX_MASK;
+		if (((next - home) & KLYS_SNAPSHOT_INDEX_MASK) >= ((next - slot) & KLYS_SNAPSHOT_INDEX_MASK)) {
+			snapshot->index[slot] = snapshot->index[next];
+			slot = next;
+		}
+	}
+	snapshot->index[slot] = -1;
+}
+
 /**
  * Get the list of klystron devices that we need to query.
  * If this is a multi-get query then we need to get the list from the mandatory devices argument
@@ -455,6 +653,10 @@ Table aidaSetValueWithResponse(JNIEnv* env, const char* uri, Arguments arguments
 		RETURN_NULL_TABLE
 	}
 
+	if (startsWith(uri, "KLYSTRONSET")) {
+		return multiSetPdesOrKphrValue(env, uri, arguments, value);
+	}
+
 	PMU_STRING_FROM_URI(pmu_str, uri)
 
 	if (endsWith(uri, "TACT")) {
@@ -469,6 +671,104 @@ Table aidaSetValueWithResponse(JNIEnv* env, const char* uri, Arguments arguments
 	}
 }
 
+/**
+ * Multi-Set the PDES or KPHR values of a list of klystrons, and return a table of the PHAS readback of each.
+ * The names are validated once for the whole list, then the klystron helper sets and trims each one in turn.
+ * A klystron that fails to trim doesn't stop the others, its opstat is false
+ *
+ * @param env to be used to throw exceptions using aidaThrow() and aidaThrowNonOsException()
+ * @param uri the uri
+ * @param arguments the arguments
+ * @param value the value argument which contains the list of device names and values
+ * @return a table with the name, opstat, and PHAS readback of each klystron
+ */
+static Table multiSetPdesOrKphrValue(JNIEnv* env, const char* uri, Arguments arguments, Value value)
+{
+	char* secn;
+	if (endsWith(uri, "PDES")) {
+		secn = "PDES";
+	} else if (endsWith(uri, "KPHR")) {
+		secn = "KPHR";
+	} else {
+		aidaThrowNonOsException(env, UNSUPPORTED_CHANNEL_EXCEPTION, uri);
+		RETURN_NULL_TABLE
+	}
+
+	// Trim only applies to PDES
+	unsigned char trim = true;
+	if (ascanf(env, &arguments, "%ob", "TRIM", &trim)) {
+		RETURN_NULL_TABLE
+	}
+
+	// Get the arguments, validating all the names at once
+	int count;
+
+	TRACK_ALLOCATED_MEMORY
+	char* primaryList = NULL, * microList = NULL, * name_validity = NULL;
+	int* unitList = NULL;
+
+	int4u secnCode;
+	float* setValues = NULL;
+
+	if (getKlystronMultiSetArguments(env, uri,
+			arguments, value, &count, &primaryList, &microList, &unitList, &secnCode, &setValues, &name_validity)) {
+		RETURN_NULL_TABLE
+	}
+	TRACK_MEMORY(primaryList)
+	TRACK_MEMORY(microList)
+	TRACK_MEMORY(name_validity)
+	TRACK_MEMORY(unitList)
+	TRACK_MEMORY(setValues)
+
+	// One block for the name pointers, names, PHAS readbacks, statuses, and opstats
+	char** names = ALLOCATE_MEMORY(env,
+			count * (sizeof(char*) + KLYS_STATUS_NAME_LEN + sizeof(float) + sizeof(vmsstat_t) + sizeof(bool)),
+			"klystron trim results");
+	if (!names) {
+		FREE_MEMORY
+		RETURN_NULL_TABLE
+	}
+	TRACK_MEMORY(names)
+	char* namesData = (char*)(names + count);
+	float* phasValues = (float*)(namesData + count * KLYS_STATUS_NAME_LEN);
+	vmsstat_t* statuses = (vmsstat_t*)(phasValues + count);
+	bool* opstats = (bool*)(statuses + count);
+
+	// Convert values to VMS floats
+	CONVERT_TO_VMS_FLOAT(setValues, count);
+
+	// Set and trim all the klystrons, PHAS readbacks are returned in ieee format
+	int nSet = DPSLCKLYS_SETTRIMPHASES(count, primaryList, microList, unitList, secn, setValues,
+			strcmp(secn, "PDES") == 0 ? (trim ? "YES" : "NO") : NULL, phasValues, statuses);
+	if (!nSet) {
+		vmsstat_t status = statuses[0];
+		FREE_MEMORY
+		aidaThrow(env, status, UNABLE_TO_SET_DATA_EXCEPTION, "Error setting values");
+		RETURN_NULL_TABLE
+	}
+
+	for (int i = 0; i < count; i++) {
+		names[i] = namesData + i * KLYS_STATUS_NAME_LEN;
+		snprintf(names[i], KLYS_STATUS_NAME_LEN, "%.*s:%.*s:%d",
+				PRIM_LEN, primaryList + i * PRIM_LEN, MICRO_LEN, microList + i * MICRO_LEN, unitList[i]);
+		opstats[i] = SUCCESS(statuses[i]);
+	}
+
+	Table table = tableCreate(env, count, 3);
+	if (!(*env)->ExceptionCheck(env)) {
+		tableAddStringColumn(env, &table, names);
+	}
+	if (!(*env)->ExceptionCheck(env)) {
+		tableAddColumn(env, &table, AIDA_BOOLEAN_TYPE, opstats, true);
+	}
+	if (!(*env)->ExceptionCheck(env)) {
+		tableAddColumn(env, &table, AIDA_FLOAT_TYPE, phasValues, true);
+	}
+
+	FREE_MEMORY
+	return table;
+}
+
 static void setPconOrAconValue(JNIEnv* env, Arguments arguments, Value value, char* pmu, char* secn)
 {
 	if (value.type != AIDA_STRING_TYPE) {
@@ -663,20 +963,6 @@ static int klystronStatus(JNIEnv* env, char slcName[30], char* beam_c, char* dgr
 	return klystronStatusImpl(env, slcName, beam_c, dgrp_c, klys_status, true);
 }
 
-/**
- * Get Status and don't throw an exception on errors
- *
- * @param env
- * @param uri
- * @param arguments
- * @param klys_status
- * @return
- */
-static int klystronStatusDontThrow(JNIEnv* env, char slcName[30], char* beam_c, char* dgrp_c, short* klys_status)
-{
-	return klystronStatusImpl(env, slcName, beam_c, dgrp_c, klys_status, false);
-}
-
 /**
  * Get Status implementation
  *
@@ -11,10 +11,12 @@ extern "C" {
 extern vmsstat_t DPSLCKLYS_DB_INIT(void);
 extern int DPSLCKLYS_DBGETKLYSFLOAT(char*, float*);
 extern int DPSLCKLYS_GETSTATUS(char*, char*, char*, short*);
+extern int DPSLCKLYS_GETSTATUSES(int, char**, char*, char*, short*, vmsstat_t*);
 extern int DPSLCKLYS_ACCESSENABLED(void);
 extern int DPSLCKLYS_SETDEACTORREACT(char*, int, char*);
 extern int DPSLCKLYS_SETCONFIG(char*, float*, char*);
 extern int DPSLCKLYS_SETTRIMPHASE(char*, char*, float*, char*, float*);
+extern int DPSLCKLYS_SETTRIMPHASES(int, char *, char *, int *, char *, float *, char *, float *, vmsstat_t *);
 extern void JNI_ERR_KLYSTRANSLATE(const unsigned long int*, struct dsc$descriptor*);
 extern void DPSLCKLYS_SETNAMESVALIDATE(int, char *, char *, int *, int4u, char *);
 extern int DPSLCKLYS_SETVALUES(int, char *, char *, int *, int4u, float *);
@@ -28,6 +30,45 @@ extern int DPSLCKLYS_SETVALUES(int, char *, char *, int *, int4u, float *);
 #define LINKLYSTA_PAMPL       0x0020
 #define LINKLYSTA_SLEDED      0x0010
 #define LINKLYSTA_PPHAS       0x0040
+
+#define MAX_KLYS_STATUS_SNAPSHOTS  8            // Most beam code and display group status snapshots held at once
+#define MAX_KLYS_SNAPSHOT_DEVICES  512          // Most klystron statuses held in one snapshot
+#define KLYS_SNAPSHOT_INDEX_SIZE  1024          // Slots in a snapshot's index by name hash, a power of two
+#define KLYS_SNAPSHOT_INDEX_MASK  (KLYS_SNAPSHOT_INDEX_SIZE - 1)
+#define KLYS_STATUS_SNAPSHOT_IDLE_EXPIRY  300.0 // Seconds a snapshot is kept without being requested
+#define KLYS_STATUS_NAME_LEN  24                // Longest klystron name, including terminator, held in a snapshot
+#define KLYS_STATUS_DGRP_LEN  8                 // Significant characters of a display group name
+
+/**
+ * The decoding of the bits of a klystron status word, given as the label of the status column
+ * when a raw status table is returned
+ */
+#define KLYS_STATUS_DECODE "klystron status: 0x01 accel, 0x02 standby, 0x04 bad, 0x08 sled tuned, 0x10 sleded, 0x20 pampl, 0x40 pphas"
+
+/**
+ * The status word of a klystron, and when it was obtained
+ */
+typedef struct
+{
+	char name[KLYS_STATUS_NAME_LEN];
+	unsigned int hash;                  // The aidaHash() of the name
+	short status;
+	double acquired;                    // When the status was obtained, in seconds
+} KlystronStatus;
+
+/**
+ * The latest status words obtained for the klystrons requested on a beam code and display group,
+ * indexed by the hash of the klystron names
+ */
+typedef struct
+{
+	int beam;
+	char dgrp[KLYS_STATUS_DGRP_LEN + 1];
+	double lastRequested;               // When the snapshot was last requested, in seconds, 0 when not in use
+	int count;
+	KlystronStatus statuses[MAX_KLYS_SNAPSHOT_DEVICES];
+	short index[KLYS_SNAPSHOT_INDEX_SIZE];  // The status in each slot, by hash of the name, -1 for unused slots
+} KlystronStatusSnapshot;
 #ifdef __cplusplus
 }
 #endif
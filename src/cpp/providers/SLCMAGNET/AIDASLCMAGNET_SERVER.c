@@ -5,18 +5,31 @@
  *
  * Magnet Server implementation
  */
+#include <ctype.h>
+#include <limits.h>
 #include "aida_pva.h"
 #include "AIDASLCMAGNET_SERVER.h"
 
 static int getBaseMagnetArguments(JNIEnv* env, const char* uri, Arguments arguments, Value value,
 		int* count, char** prim_list,
-		char** micr_list, int** unit_list, int4u* secn, float** set_values, char** name_validity);
+		char** micr_list, int** unit_list, int4u* secn, float** set_values, char** name_validity, float** limits);
 static int getMagnetArguments(JNIEnv* env, const char* uri, Arguments arguments, Value value,
 		int* count, char** prim_list,
 		char** micr_list, int** unit_list, int4u* secn, float** set_values, char** magFunc, char** limitCheck,
-		char** name_validity);
+		char** name_validity, float** limits);
 static bool isAllValid(int count, const char* name_validity);
 static void getInvalidNames(char* dst, int count, char* names[], const char* name_validity);
+static Table getMagnetTable(JNIEnv* env, const char* uri, const char* micrPattern, const char* unitPattern);
+static Table getMagnetSnapshotTable(JNIEnv* env, const char* uri, const char* micrPattern, const char* unitPattern,
+		const MagnetFilter* filter, float maxAge);
+static int readMagnetSnapshot(JNIEnv* env, const char* uri, MagnetSnapshot* snapshot, double now);
+static MagnetSnapshot* findMagnetSnapshot(const char* uri, double now);
+static void releaseMagnetSnapshot(MagnetSnapshot* snapshot);
+static bool compileMagnetFilter(const char* micrPattern, const char* unitPattern, MagnetFilter* filter);
+static int4u packMicro(const char* micro, size_t length);
+
+// Latest snapshots of all the magnets of a display group, primary, and secondary, for requests that give a MAXAGE
+static MagnetSnapshot magnetSnapshots[MAX_MAGNET_SNAPSHOTS];
 
 // API Stubs
 VERSION("1.0.0")
@@ -55,6 +68,10 @@ void aidaServiceInit(JNIEnv* env)
 /**
  * Get a table of data
  *
+ * If a MAXAGE is given then the table is instead selected, by MICROS and UNITS ranges, from the latest
+ * snapshot of all the magnets of the display group, primary, and secondary, as long as it is no older than
+ * MAXAGE seconds.  Otherwise a new snapshot is acquired first.
+ *
  * @param env to be used to throw exceptions using aidaThrow() and aidaThrowNonOsException()
  * @param uri the uri
  * @param arguments the arguments
@@ -66,22 +83,53 @@ Table aidaRequestTable(JNIEnv* env, const char* uri, Arguments arguments)
 
 	// Get arguments
 	char* micrPattern = NULL, * unitPattern = NULL;
-	if (ascanf(env, &arguments, "%os %os",
+	float maxAge = 0.0f;
+	if (ascanf(env, &arguments, "%os %os %of",
 			"micros", &micrPattern,
-			"units", &unitPattern
+			"units", &unitPattern,
+			"maxAge", &maxAge
 	)) {
 		RETURN_NULL_TABLE;
 	}
 	TRACK_MEMORY(micrPattern)
 	TRACK_MEMORY(unitPattern)
 
+	if (maxAge < 0.0f) {
+		FREE_MEMORY
+		aidaThrowNonOsException(env, UNABLE_TO_GET_DATA_EXCEPTION, "MAXAGE argument out of range");
+		RETURN_NULL_TABLE
+	}
+
+	// Select from the snapshot if the client accepts values MAXAGE seconds old, and gave ranges it can select by
+	MagnetFilter filter;
+	Table table;
+	if (maxAge > 0.0f && compileMagnetFilter(micrPattern, unitPattern, &filter)) {
+		table = getMagnetSnapshotTable(env, uri, micrPattern, unitPattern, &filter, maxAge);
+	} else {
+		table = getMagnetTable(env, uri, micrPattern, unitPattern);
+	}
+
+	FREE_MEMORY
+	return table;
+}
+
+/**
+ * Get a table of the magnets in the given micro and unit ranges, and their secondary values, selected by the database
+ *
+ * @param env to be used to throw exceptions using aidaThrow() and aidaThrowNonOsException()
+ * @param uri the uri
+ * @param micrPattern the micro pattern, or NULL for all micros
+ * @param unitPattern the unit pattern, or NULL for all units
+ * @return the table
+ */
+static Table getMagnetTable(JNIEnv* env, const char* uri, const char* micrPattern, const char* unitPattern)
+{
 	// Acquire Magnet values
 	int numMagnetPvs;
 	TO_LEGACY_NAME(uri, legacyName)
-	vmsstat_t status = DPSLCMAGNET_GET((char*)legacyName, (micrPattern ? micrPattern : "ALL*"),
-			(unitPattern ? unitPattern : "ALL*"),
+	vmsstat_t status = DPSLCMAGNET_GET((char*)legacyName, (char*)(micrPattern ? micrPattern : "ALL*"),
+			(char*)(unitPattern ? unitPattern : "ALL*"),
 			&numMagnetPvs);
-	FREE_MEMORY
 	if (!SUCCESS(status)) {
 		aidaThrow(env, status, UNABLE_TO_GET_DATA_EXCEPTION, "while reading magnet values");
 		DPSLCMAGNET_GETCLEANUP();
@@ -148,7 +196,7 @@ void aidaSetValue(JNIEnv* env, const char* uri, Arguments arguments, Value value
 	float* setValues = NULL;
 
 	if (getBaseMagnetArguments(env, uri,
-			arguments, value, &count, &primaryList, &microList, &unitList, &secn, &setValues, &name_validity)) {
+			arguments, value, &count, &primaryList, &microList, &unitList, &secn, &setValues, &name_validity, NULL)) {
 		return;
 	}
 	TRACK_MEMORY(primaryList)
@@ -220,12 +268,12 @@ Table aidaSetValueWithResponse(JNIEnv* env, const char* uri, Arguments arguments
 	int4u secn;
 	char* primaryList, * microList, * magnetFunction, * limitCheck, * name_validity;
 	int* unitList;
-	float* setValues;
+	float* setValues, * setLimits;
 	int limitCheckAll = true;
 	if (getMagnetArguments(env, uri, arguments, value, &count,
 			&primaryList, &microList, &unitList, &secn, &setValues,
 			&magnetFunction, &limitCheck,
-			&name_validity)) {
+			&name_validity, &setLimits)) {
 		RETURN_NULL_TABLE
 	}
 	TRACK_MEMORY(primaryList)
@@ -235,6 +283,7 @@ Table aidaSetValueWithResponse(JNIEnv* env, const char* uri, Arguments arguments
 	TRACK_MEMORY(name_validity)
 	TRACK_MEMORY(magnetFunction)
 	TRACK_MEMORY(limitCheck)
+	TRACK_MEMORY(setLimits)
 
 	if (strcasecmp(magnetFunction, "TRIM") != 0 && strcasecmp(magnetFunction, "PTRB") != 0
 			&& strcasecmp(magnetFunction, "NOFUNC") != 0) {
@@ -253,56 +302,43 @@ Table aidaSetValueWithResponse(JNIEnv* env, const char* uri, Arguments arguments
 		limitCheckAll = false;
 	}
 
-	// Check limits
-	bool withinLimits[count], allSetValuesWithinLimits = true;  // true if within limits
+	// Check limits, without branching, so that the loop can be vectorised
+	unsigned char withinLimits[count];  // 1 if within limits
 	int numPairsWithinLimits = 0;
-	float magnetLimits[count * 2];
-	DPSLCMAGNET_RET_MAGLIMITS(count, &magnetLimits[0]);
-	CONVERT_FROM_VMS_FLOAT(&magnetLimits[0], count * 2)
 	for (int i = 0; i < count; i++) {
-		float lowerLimit = magnetLimits[i * 2];
-		float upperLimit = magnetLimits[i * 2 + 1];
-		if ((setValues[i] < lowerLimit) || (setValues[i] > upperLimit)) {
-			withinLimits[i] = false;
-			allSetValuesWithinLimits = false;
-		} else {
-			withinLimits[i] = true;
-			numPairsWithinLimits++;
-		}
+		withinLimits[i] = !((setValues[i] < setLimits[i * 2]) | (setValues[i] > setLimits[i * 2 + 1]));
+		numPairsWithinLimits += withinLimits[i];
 	}
-	if (!allSetValuesWithinLimits && limitCheckAll || !numPairsWithinLimits) {
+	if ((numPairsWithinLimits < count && limitCheckAll) || !numPairsWithinLimits) {
 		aidaThrowNonOsException(env, UNABLE_TO_SET_DATA_EXCEPTION,
 				"Some or all of the set values are outside of the limits");
 		FREE_MEMORY
 		RETURN_NULL_TABLE
 	}
 
-	// Use only the values that are within limits
-	char limitedPrimList[(numPairsWithinLimits * PRIM_LEN) + 1];
-	char limitedMicrList[(numPairsWithinLimits * MICRO_LEN) + 1];
-	int limitedUnitList[numPairsWithinLimits];
-	float limitedValuesList[numPairsWithinLimits];
-
-	int limitedCounter = 0;
-	for (int i = 0; i < count; i++) {
-		if (withinLimits[i]) {
-			memcpy(limitedPrimList + limitedCounter * PRIM_LEN, primaryList + i * PRIM_LEN, PRIM_LEN);
-			memcpy(limitedMicrList + limitedCounter * MICRO_LEN, microList + i * MICRO_LEN, MICRO_LEN);
-			limitedUnitList[limitedCounter] = unitList[i];
-			limitedValuesList[limitedCounter] = setValues[i];
-			limitedCounter++;
+	// Use only the values that are within limits, compacting the lists in place
+	if (numPairsWithinLimits < count) {
+		int limitedCounter = 0;
+		for (int i = 0; i < count; i++) {
+			if (withinLimits[i]) {
+				memmove(primaryList + limitedCounter * PRIM_LEN, primaryList + i * PRIM_LEN, PRIM_LEN);
+				memmove(microList + limitedCounter * MICRO_LEN, microList + i * MICRO_LEN, MICRO_LEN);
+				unitList[limitedCounter] = unitList[i];
+				setValues[limitedCounter] = setValues[i];
+				limitedCounter++;
+			}
 		}
+		primaryList[(numPairsWithinLimits * PRIM_LEN)] = 0x0;
+		microList[(numPairsWithinLimits * MICRO_LEN)] = 0x0;
 	}
-	limitedPrimList[(numPairsWithinLimits * PRIM_LEN)] = 0x0;
-	limitedMicrList[(numPairsWithinLimits * PRIM_LEN)] = 0x0;
 
 	// Convert values to VMS floats
-	CONVERT_TO_VMS_FLOAT(limitedValuesList, numPairsWithinLimits);
+	CONVERT_TO_VMS_FLOAT(setValues, numPairsWithinLimits);
 
 	// Set the PVs specified by the lists of primary, micros, and units
 	vmsstat_t status;
-	status = DPSLCMAGNET_SET(numPairsWithinLimits, limitedPrimList, limitedMicrList, limitedUnitList, secn,
-			limitedValuesList, magnetFunction);
+	status = DPSLCMAGNET_SET(numPairsWithinLimits, primaryList, microList, unitList, secn,
+			setValues, magnetFunction);
 	FREE_MEMORY
 	if (!SUCCESS(status)) {
 		aidaThrow(env, status, UNABLE_TO_SET_DATA_EXCEPTION, "while setting magnet values");
@@ -342,11 +378,14 @@ Table aidaSetValueWithResponse(JNIEnv* env, const char* uri, Arguments arguments
  * @param unit_list
  * @param secn
  * @param set_values
+ * @param name_validity
+ * @param limits if not NULL, set to the low and high limits of each magnet, in ieee format.
+ * The magnet names are always validated first, and the limits are then read for the validated magnets
  * @return
  */
 static int
 getBaseMagnetArguments(JNIEnv* env, const char* uri, Arguments arguments, Value value, int* count, char** prim_list,
-		char** micr_list, int** unit_list, int4u* secn, float** set_values, char** name_validity)
+		char** micr_list, int** unit_list, int4u* secn, float** set_values, char** name_validity, float** limits)
 {
 	TRACK_ALLOCATED_MEMORY
 	*prim_list = NULL;
@@ -354,6 +393,9 @@ getBaseMagnetArguments(JNIEnv* env, const char* uri, Arguments arguments, Value
 	*unit_list = NULL;
 	*set_values = NULL;
 	*name_validity = NULL;
+	if (limits) {
+		*limits = NULL;
+	}
 
 	unsigned int nNames, nValues;
 	char** names = NULL;
@@ -408,6 +450,14 @@ getBaseMagnetArguments(JNIEnv* env, const char* uri, Arguments arguments, Value
 				EXIT_FAILURE)
 	}
 
+	// Get the limits of the validated magnets, read afresh for every set as they gate the set
+	if (limits) {
+		ALLOCATE_AND_TRACK_MEMORY_AND_ON_ERROR_RETURN_(env, *limits, *count * 2 * sizeof(float), "magnet limits",
+				EXIT_FAILURE)
+		DPSLCMAGNET_RET_MAGLIMITS(*count, *limits);
+		CONVERT_FROM_VMS_FLOAT(*limits, *count * 2)
+	}
+
 	// Free up the names as we don't need them anymore as they have been validated
 	FREE_TRACKED_MEMORY(names)
 
@@ -429,19 +479,21 @@ getBaseMagnetArguments(JNIEnv* env, const char* uri, Arguments arguments, Value
  * @param set_values
  * @param magFunc
  * @param limitCheck
+ * @param name_validity
+ * @param limits
  * @return
  */
 static int
 getMagnetArguments(JNIEnv* env, const char* uri, Arguments arguments, Value value, int* count, char** prim_list,
 		char** micr_list, int** unit_list, int4u* secn, float** set_values, char** magFunc, char** limitCheck,
-		char** name_validity)
+		char** name_validity, float** limits)
 {
 	*magFunc = NULL;
 	*limitCheck = NULL;
 
 	TRACK_ALLOCATED_MEMORY
 	if (getBaseMagnetArguments(env, uri, arguments, value, count, prim_list, micr_list, unit_list, secn, set_values,
-			name_validity)) {
+			name_validity, limits)) {
 		return EXIT_FAILURE;
 	}
 	TRACK_MEMORY(prim_list)
@@ -449,6 +501,7 @@ getMagnetArguments(JNIEnv* env, const char* uri, Arguments arguments, Value valu
 	TRACK_MEMORY(unit_list)
 	TRACK_MEMORY(set_values)
 	TRACK_MEMORY(name_validity)
+	TRACK_MEMORY(*limits)
 
 	if (ascanf(env, &arguments, "%s %os",
 			"magfunc", magFunc,
@@ -507,3 +560,265 @@ static void getInvalidNames(char* dst, int count, char* names[], const char* nam
 	}
 }
 
+/**
+ * Get the magnets in the given micro and unit ranges, and their secondary values, from the snapshot for the uri.
+ * The snapshot is acquired first if it is older than maxAge seconds.
+ *
+ * The micro range is taken in the order the database returns the magnets, as the database takes it, from the first
+ * magnet of the start micro to the last magnet of the end micro.  If the snapshot can't give the same magnets,
+ * because either micro is not in it, or none of the magnets in the range are in the unit range, then they are
+ * selected by the database instead, so that the result is the same as without a MAXAGE
+ *
+ * @param env to be used to throw exceptions using aidaThrow() and aidaThrowNonOsException()
+ * @param uri the uri
+ * @param micrPattern the micro pattern, or NULL for all micros
+ * @param unitPattern the unit pattern, or NULL for all units
+ * @param filter the micro and unit ranges to select
+ * @param maxAge the maximum age, in seconds, of the values that can be returned
+ * @return the table
+ */
+static Table getMagnetSnapshotTable(JNIEnv* env, const char* uri, const char* micrPattern, const char* unitPattern,
+		const MagnetFilter* filter, float maxAge)
+{
+	double now = aidaTimeNow();
+	MagnetSnapshot* snapshot = findMagnetSnapshot(uri, now);
+	snapshot->lastRequested = now;
+
+	if (!snapshot->acquired || now - snapshot->acquired > maxAge) {
+		if (readMagnetSnapshot(env, uri, snapshot, now)) {
+			RETURN_NULL_TABLE
+		}
+	}
+
+	// A display group, primary, and secondary with no magnets at all is kept as an empty snapshot
+	if (!snapshot->rows) {
+		aidaThrowNonOsException(env, UNABLE_TO_GET_DATA_EXCEPTION, "No magnets are in the given MICROS and UNITS");
+		RETURN_NULL_TABLE
+	}
+
+	// Find the micro range in the order the magnets were returned
+	int firstRow = 0, lastRow = snapshot->rows - 1;
+	if (filter->microLow) {
+		while (firstRow < snapshot->rows && snapshot->micros[firstRow] != filter->microLow) {
+			firstRow++;
+		}
+		while (lastRow >= 0 && snapshot->micros[lastRow] != filter->microHigh) {
+			lastRow--;
+		}
+	}
+
+	// Count the magnets of the micro range in the unit range, without branching, so that the loop can be vectorised
+	int rows = 0;
+	for (int i = firstRow; i <= lastRow; i++) {
+		rows += (snapshot->units[i] >= filter->unitLow) & (snapshot->units[i] <= filter->unitHigh);
+	}
+
+	if (!rows) {
+		return getMagnetTable(env, uri, micrPattern, unitPattern);
+	}
+
+	// To hold the selected data
+	float* secondaryValues = ALLOCATE_MEMORY(env, rows * (sizeof(float) + MAX_PMU_STRING_LEN), "magnet data");
+	if (!secondaryValues) {
+		RETURN_NULL_TABLE
+	}
+	char* namesData = (char*)(secondaryValues + rows);
+
+	for (int i = firstRow, row = 0; row < rows; i++) {
+		if (snapshot->units[i] >= filter->unitLow && snapshot->units[i] <= filter->unitHigh) {
+			memcpy(namesData + row * MAX_PMU_STRING_LEN, snapshot->namesData + i * MAX_PMU_STRING_LEN,
+					MAX_PMU_STRING_LEN);
+			secondaryValues[row++] = snapshot->secondaryValues[i];
+		}
+	}
+
+	// Make table and return results
+	Table table = tableCreate(env, rows, 2);
+	if (!(*env)->ExceptionCheck(env)) {
+		tableAddFixedWidthStringColumn(env, &table, namesData, MAX_PMU_STRING_LEN);
+	}
+	if (!(*env)->ExceptionCheck(env)) {
+		tableAddColumn(env, &table, AIDA_FLOAT_TYPE, secondaryValues, true);
+	}
+
+	free(secondaryValues);
+	return table;
+}
+
+/**
+ * Acquire the names and secondary values of all the magnets of the uri's display group, primary,
+ * and secondary, into the given snapshot.  On failure the snapshot is left with no rows, and is not acquired
+ *
+ * @param env to be used to throw exceptions using aidaThrow() and aidaThrowNonOsException()
+ * @param uri the uri
+ * @param snapshot the snapshot
+ * @param now the time now, in seconds
+ * @return EXIT_SUCCESS if all goes well
+ */
+static int readMagnetSnapshot(JNIEnv* env, const char* uri, MagnetSnapshot* snapshot, double now)
+{
+	int numMagnetPvs;
+	TO_LEGACY_NAME(uri, legacyName)
+
+	snapshot->rows = 0;
+	snapshot->acquired = 0.0;
+	vmsstat_t status = DPSLCMAGNET_GET((char*)legacyName, ALL_MAGNETS_PATTERN, ALL_MAGNETS_PATTERN, &numMagnetPvs);
+	if (!SUCCESS(status)) {
+		aidaThrow(env, status, UNABLE_TO_GET_DATA_EXCEPTION, "while reading magnet values");
+		DPSLCMAGNET_GETCLEANUP();
+		return EXIT_FAILURE;
+	}
+
+	// No magnets, so the snapshot is kept empty until it is older than the MAXAGE requested
+	if (numMagnetPvs <= 0) {
+		DPSLCMAGNET_GETCLEANUP();
+		snapshot->acquired = now;
+		return EXIT_SUCCESS;
+	}
+
+	// To hold the data.  Allocated as one block, with the names last as they are returned null terminated
+	if (numMagnetPvs > snapshot->capacity) {
+		free(snapshot->secondaryValues);
+		snapshot->capacity = 0;
+		snapshot->secondaryValues = ALLOCATE_MEMORY(env,
+				numMagnetPvs * (sizeof(float) + sizeof(int4u) + sizeof(int) + MAX_PMU_STRING_LEN) + 1,
+				"magnet snapshot");
+		if (!snapshot->secondaryValues) {
+			DPSLCMAGNET_GETCLEANUP();
+			return EXIT_FAILURE;
+		}
+		snapshot->capacity = numMagnetPvs;
+	}
+	snapshot->micros = (int4u*)(snapshot->secondaryValues + numMagnetPvs);
+	snapshot->units = (int*)(snapshot->micros + numMagnetPvs);
+	snapshot->namesData = (char*)(snapshot->units + numMagnetPvs);
+
+	// Get Names and Secondary values
+	DPSLCMAGNET_GETNAMES(snapshot->namesData);
+	DPSLCMAGNET_GETSECNVALUES(snapshot->secondaryValues);
+
+	// Cleanup
+	DPSLCMAGNET_GETCLEANUP();
+
+	CONVERT_FROM_VMS_FLOAT(snapshot->secondaryValues, (int2u)numMagnetPvs)
+
+	// Pack the micro, and get the unit, of each <prim>:<micr>:<unit> name for selecting by
+	for (int i = 0; i < numMagnetPvs; i++) {
+		const char* name = snapshot->namesData + i * MAX_PMU_STRING_LEN;
+		snapshot->micros[i] = packMicro(name + PRIM_LEN + 1, MICRO_LEN);
+
+		int unit = 0;
+		for (int j = PRIM_LEN + MICRO_LEN + 2; j < MAX_PMU_STRING_LEN && isdigit((unsigned char)name[j]); j++) {
+			unit = unit * 10 + name[j] - '0';
+		}
+		snapshot->units[i] = unit;
+	}
+
+	snapshot->rows = numMagnetPvs;
+	snapshot->acquired = now;
+	return EXIT_SUCCESS;
+}
+
+/**
+ * Find the snapshot for the given uri, releasing any idle snapshots on the way.
+ * If there is none then a free snapshot is taken for it, or the least recently requested one if none are free
+ *
+ * @param uri the uri
+ * @param now the time now, in seconds
+ * @return the snapshot
+ */
+static MagnetSnapshot* findMagnetSnapshot(const char* uri, double now)
+{
+	MagnetSnapshot* found = NULL, * freeSnapshot = NULL, * oldest = NULL;
+
+	for (int i = 0; i < MAX_MAGNET_SNAPSHOTS; i++) {
+		MagnetSnapshot* snapshot = &magnetSnapshots[i];
+		if (*snapshot->uri && now - snapshot->lastRequested > MAGNET_SNAPSHOT_IDLE_EXPIRY) {
+			releaseMagnetSnapshot(snapshot);
+		}
+
+		if (!*snapshot->uri) {
+			if (!freeSnapshot) {
+				freeSnapshot = snapshot;
+			}
+		} else if (strcasecmp(snapshot->uri, uri) == 0) {
+			found = snapshot;
+		} else if (!oldest || snapshot->lastRequested < oldest->lastRequested) {
+			oldest = snapshot;
+		}
+	}
+
+	if (found) {
+		return found;
+	}
+
+	if (!freeSnapshot) {
+		releaseMagnetSnapshot(oldest);
+		freeSnapshot = oldest;
+	}
+	strncpy(freeSnapshot->uri, uri, MAX_URI_LEN - 1);
+	return freeSnapshot;
+}
+
+/**
+ * Release the given snapshot, freeing its data
+ *
+ * @param snapshot the snapshot
+ */
+static void releaseMagnetSnapshot(MagnetSnapshot* snapshot)
+{
+	free(snapshot->secondaryValues);
+	memset(snapshot, 0, sizeof(MagnetSnapshot));
+}
+
+/**
+ * Compile the given MICROS and UNITS patterns into the ranges to select magnets from a snapshot by.
+ * Each pattern is either a `<start>-<end>` range or ALL_MAGNETS_PATTERN, which is also the default
+ *
+ * @param micrPattern the micro pattern, `<start_micro>-<end_micro>`, or NULL
+ * @param unitPattern the unit pattern, `<start_unit>-<end_unit>`, or NULL
+ * @param filter the ranges, set on return
+ * @return true if both patterns could be compiled, false if the magnets must be selected by the database instead
+ */
+static bool compileMagnetFilter(const char* micrPattern, const char* unitPattern, MagnetFilter* filter)
+{
+	char low[MICRO_LEN + 1], high[MICRO_LEN + 1];
+	int end = 0;
+
+	filter->microLow = 0;
+	filter->microHigh = 0;
+	filter->unitLow = 0;
+	filter->unitHigh = INT_MAX;
+
+	if (micrPattern && strcasecmp(micrPattern, ALL_MAGNETS_PATTERN) != 0) {
+		if (sscanf(micrPattern, "%4[^-]-%4s%n", low, high, &end) != 2 || micrPattern[end]) {
+			return false;
+		}
+		filter->microLow = packMicro(low, strlen(low));
+		filter->microHigh = packMicro(high, strlen(high));
+	}
+
+	if (unitPattern && strcasecmp(unitPattern, ALL_MAGNETS_PATTERN) != 0) {
+		if (sscanf(unitPattern, "%d-%d%n", &filter->unitLow, &filter->unitHigh, &end) != 2 || unitPattern[end]) {
+			return false;
+		}
+	}
+
+	return true;
+}
+
+/**
+ * Pack a micro name into a 4 byte code, upper cased and padded with spaces, so that it can be compared in one go
+ *
+ * @param micro the micro name
+ * @param length its length, up to MICRO_LEN
+ * @return the packed code
+ */
+static int4u packMicro(const char* micro, size_t length)
+{
+	int4u code = 0;
+	for (int i = 0; i < MICRO_LEN; i++) {
+		code = (code << 8) | (i < length ? (unsigned char)toupper((unsigned char)micro[i]) : ' ');
+	}
+	return code;
+}
@@ -12,6 +12,41 @@ extern "C" {
 #define MAX_STATE_NAME_LEN 9
 #define MAX_VALIDITY_STRING_LEN 40
 
+#define MAX_MAGNET_SNAPSHOTS  16            // Most primary and secondary snapshots held at once
+#define MAGNET_SNAPSHOT_IDLE_EXPIRY  300.0  // Seconds a snapshot is kept without being requested
+#define ALL_MAGNETS_PATTERN "ALL*"          // The micro or unit pattern that matches all magnets
+
+/**
+ * The range of micros and units that a magnet must be in to be selected from a snapshot.
+ * The micro range runs from the first magnet of microLow to the last of microHigh, in the order the database
+ * returns the magnets, both 0 for all micros.  Micros are compared as packed 4 byte codes
+ */
+typedef struct
+{
+	int4u microLow;
+	int4u microHigh;
+	int unitLow;
+	int unitHigh;
+} MagnetFilter;
+
+/**
+ * The names and secondary values of all the magnets of a display group, primary, and secondary.
+ * All the data is held in one block allocated at secondaryValues, and is kept, and reused,
+ * for subsequent acquisitions of up to capacity magnets
+ */
+typedef struct
+{
+	char uri[MAX_URI_LEN];              // Empty when the snapshot is not in use
+	int rows;
+	int capacity;
+	double acquired;                    // When the values were acquired, in seconds
+	double lastRequested;               // When the snapshot was last requested, in seconds
+	float* secondaryValues;             // In ieee format
+	int4u* micros;                      // Packed micro code of each magnet
+	int* units;
+	char* namesData;                    // MAX_PMU_STRING_LEN characters for each magnet
+} MagnetSnapshot;
+
 extern vmsstat_t DPSLCMAGNET_DB_INIT(void);
 extern vmsstat_t DPSLCMAGNET_GET(char*, char*, char*, int*);
 extern int DPSLCMAGNET_GETNUMPVS(void);
@@ -7,6 +7,16 @@
 #include "AIDASLCMOSC_SERVER.h"
 
 static int getMoscArguments(JNIEnv* env, Arguments arguments, Value value, char** units, char** ring, float* floatValue);
+static MoscSample* getMoscSample(JNIEnv* env);
+static MoscSample* addMoscSample(double time, double frequency);
+static Table getMoscSamples(JNIEnv* env, Arguments arguments);
+
+// The latest measurements, in a ring with the next to be replaced at nextMoscSample
+static MoscSample moscSamples[MOSC_SAMPLES];
+static int nMoscSamples = 0, nextMoscSample = 0;
+
+// Seconds between measurements, however often it is requested.  Configured when the service is initialised
+static double moscSampleInterval = MOSC_SAMPLE_INTERVAL;
 
 // API Stubs
 VERSION("1.0.0")
@@ -28,7 +38,10 @@ REQUEST_STUB_STRING_ARRAY
 SET_STUB_VOID
 
 /**
- * Initialise the service
+ * Initialise the service.  The seconds between measurements of the oscillator are taken from the
+ * `AIDA_SLCMOSC_SAMPLE_INTERVAL` environment variable (a global symbol in VMS terminology) if it is set,
+ * otherwise they default to MOSC_SAMPLE_INTERVAL
+ *
  * @param env to be used to throw exceptions using aidaThrow() and aidaThrowNonOsException()
  * @throws ServerInitialisationException if the service fails to initialise
  */
@@ -36,15 +49,28 @@ void aidaServiceInit(JNIEnv* env)
 {
 	vmsstat_t status;
 
+	char* interval = getenv(MOSC_SAMPLE_INTERVAL_NAME);
+	if (interval) {
+		char* end;
+		moscSampleInterval = strtod(interval, &end);
+		if (end == interval || *end || moscSampleInterval < 0.0) {
+			aidaThrowNonOsException(env, SERVER_INITIALISATION_EXCEPTION,
+					MOSC_SAMPLE_INTERVAL_NAME " must be a number of seconds, zero or more");
+			return;
+		}
+	}
+
 	if (!$VMS_STATUS_SUCCESS(status = init("AIDA_SLCMOSC", false))) {
 		aidaThrow(env, status, SERVER_INITIALISATION_EXCEPTION, "initialising Master Oscillator Service");
 	} else {
-		printf("AIDA-PVA Master Oscillator Provider\n");
+		printf("AIDA-PVA Master Oscillator Provider, measuring at most every %g seconds\n", moscSampleInterval);
 	}
 }
 
 /**
- * Get a double
+ * Get a double.  The oscillator is measured at most once every sample interval, see aidaServiceInit(),
+ * however often it is requested, so the latest measurement is returned if it is more recent than that.
+ * The value returned may therefore be up to the sample interval old
  *
  * @param env to be used to throw exceptions using aidaThrow() and aidaThrowNonOsException()
  * @param uri the uri
@@ -53,28 +79,16 @@ void aidaServiceInit(JNIEnv* env)
  */
 double aidaRequestDouble(JNIEnv* env, const char* uri, Arguments arguments)
 {
-	// Check if operations are enabled?
-	if (!DPSLCMOSC_ACCESSENABLED()) {
-		aidaThrowNonOsException(env, UNABLE_TO_GET_DATA_EXCEPTION,
-				"Aida access to Master Oscillator is not currently enabled");
+	MoscSample* sample = getMoscSample(env);
+	if (!sample) {
 		return 0.0;
 	}
-
-	// Read value
-	double meas_abs_freq;
-	vmsstat_t status;
-	status = DPSLCMOSC_MEASMASTEROSC(&meas_abs_freq);
-	if (!SUCCESS(status)) {
-		aidaThrow(env, status, UNABLE_TO_GET_DATA_EXCEPTION, "Unable to get oscillator frequency");
-		return 0.0;
-	}
-	CONVERT_FROM_VMS_DOUBLE(&meas_abs_freq, 1)
-
-	return meas_abs_freq;
+	return sample->frequency;
 }
 
 /**
- * Get a table of data
+ * Get a table of data.
+ * For the `MASTEROSC:SAMPLES` channel this is the measurements kept for trending, see getMoscSamples()
  *
  * @param env to be used to throw exceptions using aidaThrow() and aidaThrowNonOsException()
  * @param uri the uri
@@ -83,16 +97,22 @@ double aidaRequestDouble(JNIEnv* env, const char* uri, Arguments arguments)
  */
 Table aidaRequestTable(JNIEnv* env, const char* uri, Arguments arguments)
 {
-	// Create table to return value
-	Table table = tableCreate(env, 1, 1);
-	ON_EXCEPTION_RETURN_(table)
+	if (endsWith(uri, "SAMPLES")) {
+		return getMoscSamples(env, arguments);
+	}
 
 	// Get the value
-	double meas_abs_freq = aidaRequestDouble(env, uri, arguments);
+	MoscSample* sample = getMoscSample(env);
+	if (!sample) {
+		RETURN_NULL_TABLE
+	}
+
+	// Create table to return value
+	Table table = tableCreate(env, 1, 1);
 	ON_EXCEPTION_RETURN_(table)
 
 	// Add value to table
-	tableAddSingleRowDoubleColumn(env, &table, meas_abs_freq, true);
+	tableAddSingleRowDoubleColumn(env, &table, sample->frequency, true);
 
 	// Return table
 	return table;
@@ -143,10 +163,14 @@ Table aidaSetValueWithResponse(JNIEnv* env, const char* uri, Arguments arguments
 		RETURN_NULL_TABLE
 	}
 
+	// The frequency read back is the latest measurement
+	CONVERT_FROM_VMS_DOUBLE(&resulting_abs_freq, 1)
+	addMoscSample(aidaTimeNow(), resulting_abs_freq);
+
 	// Now create table to return
 	Table table = tableCreate(env, 1, 1);
 	ON_EXCEPTION_RETURN_(table)
-	tableAddSingleRowDoubleColumn(env, &table, resulting_abs_freq, false);
+	tableAddSingleRowDoubleColumn(env, &table, resulting_abs_freq, true);
 
 	return table;
 }
@@ -184,3 +208,109 @@ static int getMoscArguments(JNIEnv* env, Arguments arguments, Value value, char*
 	return EXIT_SUCCESS;
 }
 
+/**
+ * Get the latest measurement of the Master Oscillator, measuring it only if the latest measurement
+ * is more than the sample interval old.  This caps the rate the oscillator, which is slow to measure,
+ * is measured whatever the number of clients polling it
+ *
+ * @param env to be used to throw exceptions using aidaThrow() and aidaThrowNonOsException()
+ * @return the latest measurement, or NULL if an exception has been raised
+ */
+static MoscSample* getMoscSample(JNIEnv* env)
+{
+	// Check if operations are enabled?
+	if (!DPSLCMOSC_ACCESSENABLED()) {
+		aidaThrowNonOsException(env, UNABLE_TO_GET_DATA_EXCEPTION,
+				"Aida access to Master Oscillator is not currently enabled");
+		return NULL;
+	}
+
+	double now = aidaTimeNow();
+	if (nMoscSamples) {
+		MoscSample* latest = &moscSamples[(nextMoscSample + MOSC_SAMPLES - 1) % MOSC_SAMPLES];
+		if (now - latest->time < moscSampleInterval) {
+			return latest;
+		}
+	}
+
+	// Read value
+	double meas_abs_freq;
+	vmsstat_t status;
+	status = DPSLCMOSC_MEASMASTEROSC(&meas_abs_freq);
+	if (!SUCCESS(status)) {
+		aidaThrow(env, status, UNABLE_TO_GET_DATA_EXCEPTION, "Unable to get oscillator frequency");
+		return NULL;
+	}
+	CONVERT_FROM_VMS_DOUBLE(&meas_abs_freq, 1)
+
+	return addMoscSample(now, meas_abs_freq);
+}
+
+/**
+ * Add a measurement of the Master Oscillator, replacing the oldest once MOSC_SAMPLES are kept
+ *
+ * @param time when the measurement was made
+ * @param frequency the frequency measured, in ieee format
+ * @return the measurement added
+ */
+static MoscSample* addMoscSample(double time, double frequency)
+{
+	MoscSample* sample = &moscSamples[nextMoscSample];
+	sample->time = time;
+	sample->frequency = frequency;
+
+	nextMoscSample = (nextMoscSample + 1) % MOSC_SAMPLES;
+	if (nMoscSamples < MOSC_SAMPLES) {
+		nMoscSamples++;
+	}
+	return sample;
+}
+
+/**
+ * Get a table of the measurements of the Master Oscillator kept for trending, oldest first,
+ * after bringing them up to date.  The oscillator is only measured when one of its channels is requested,
+ * so there are only measurements for the times it has been polled, and none for any gaps between.  If a `WINDOW` is given then only the measurements made in the last
+ * `WINDOW` seconds are returned.  The following fields are returned:
+ * 		`time`		DOUBLE		when the measurement was made, in seconds since the epoch
+ * 		`value`		DOUBLE		the frequency measured, in KHz
+ *
+ * @param env to be used to throw exceptions using aidaThrow() and aidaThrowNonOsException()
+ * @param arguments the arguments
+ * @return the table
+ */
+static Table getMoscSamples(JNIEnv* env, Arguments arguments)
+{
+	float window = 0.0f;
+	if (ascanf(env, &arguments, "%of", "window", &window)) {
+		RETURN_NULL_TABLE
+	}
+
+	MoscSample* latest = getMoscSample(env);
+	if (!latest) {
+		RETURN_NULL_TABLE
+	}
+
+	// Count back from the latest measurement to the oldest in the window
+	int rows = 1;
+	while (rows < nMoscSamples) {
+		MoscSample* sample = &moscSamples[(nextMoscSample + MOSC_SAMPLES - rows - 1) % MOSC_SAMPLES];
+		if (window > 0.0f && latest->time - sample->time > window) {
+			break;
+		}
+		rows++;
+	}
+
+	double timeData[MOSC_SAMPLES], frequencyData[MOSC_SAMPLES];
+	for (int row = 0; row < rows; row++) {
+		MoscSample* sample = &moscSamples[(nextMoscSample + MOSC_SAMPLES - rows + row) % MOSC_SAMPLES];
+		timeData[row] = sample->time;
+		frequencyData[row] = sample->frequency;
+	}
+
+	Table table = tableCreate(env, rows, 2);
+	ON_EXCEPTION_RETURN_(table)
+	tableAddColumn(env, &table, AIDA_DOUBLE_TYPE, timeData, true);
+	ON_EXCEPTION_RETURN_(table)
+	tableAddColumn(env, &table, AIDA_DOUBLE_TYPE, frequencyData, true);
+	return table;
+}
@@ -14,6 +14,19 @@ extern int DPSLCMOSC_ACCESSENABLED(void);
 extern vmsstat_t DPSLCMOSC_SETMASTEROSC(float*, char*, char*, double*);
 extern void JNI_ERR_MOSCTRANSLATE(const unsigned long int*, struct dsc$descriptor*);
 
+#define MOSC_SAMPLES  256                   // Most measurements kept for trending
+#define MOSC_SAMPLE_INTERVAL  1.0           // Default seconds between measurements, however often it is requested
+#define MOSC_SAMPLE_INTERVAL_NAME  "AIDA_SLCMOSC_SAMPLE_INTERVAL"   // Environment variable to override it with
+
+/**
+ * A measurement of the Master Oscillator frequency, in ieee format, and when it was made
+ */
+typedef struct
+{
+	double time;                            // Seconds since the epoch
+	double frequency;
+} MoscSample;
+
 #ifdef __cplusplus
 }
 #endif
@@ -20,6 +20,10 @@ static void setFeedback(JNIEnv* env, const char* uri, Arguments arguments, Value
 static int4u faStatus(JNIEnv* env, const char* uri, int newHSTA, BOOLEAN retrieveOnly);
 static short getShortFaStatus(JNIEnv* env, const char* uri);
 static char* GetStringFaStatus(JNIEnv* env, const char* uri);
+static short faStateCode(int4u haStatus);
+static char* faStateName(int4u haStatus);
+static Table getTrigStatuses(JNIEnv* env, Arguments arguments);
+static Table getFaStatuses(JNIEnv* env, Arguments arguments);
 static Table phaseScan(JNIEnv* env, const char* uri, Arguments arguments);
 static bool getAcqParameters(JNIEnv* env, Arguments arguments, char** buttonFileName,
 		char** primaryStepVariable, float* primaryLow, float* primaryHigh, int* primarySteps, float* primarySettleTime,
@@ -27,11 +31,22 @@ static bool getAcqParameters(JNIEnv* env, Arguments arguments, char** buttonFile
 		char** secondaryStepVariable, float* secondaryLow, float* secondaryHigh, int* secondarySteps,
 		float* secondarySettleTime, float* secondaryExtraSettleTime, short* bpmd, long* nrpos, long* dtizavg,
 		char** magnetFunction);
-static void
-createCorrelationPlotTable(JNIEnv* env, Table* table, int totalSampleVariables, int nSteps, char* primaryStepVariable,
-		bool secondaryStepVariableProvided,
-		char* secondaryStepVariable, float* samples, long* samplesOk);
+static int getCorrPlotScan(JNIEnv* env, Arguments arguments, CorrPlotScan* scan);
+static int runCorrPlotJob(JNIEnv* env, CorrPlotJob* job);
+static int runCorrPlotSteps(JNIEnv* env, CorrPlotJob* job, int firstStep, int nSteps);
+static int getCorrPlotVariables(JNIEnv* env, CorrPlotJob* job);
 static int countSampleVariables(JNIEnv* env, long* nSampleVariables);
+static Table corrPlotJobTable(JNIEnv* env, CorrPlotJob* job, int firstRow, int nRows);
+static void* corrPlotJobColumn(void* column, void* first, void* ringStart, size_t elementSize, int nRows,
+		int nWrapped);
+static Table corrPlotJobStatusTable(JNIEnv* env, CorrPlotJob* job);
+static CorrPlotJob* findCorrPlotJob(int jobId, double now);
+static CorrPlotJob* newCorrPlotJob(JNIEnv* env, CorrPlotJob* request);
+static void releaseCorrPlotJob(CorrPlotJob* job);
+
+// Correlation plot jobs, and the id of the last job submitted
+static CorrPlotJob corrPlotJobs[MAX_CORRPLOT_JOBS];
+static int lastCorrPlotJobId = 0;
 
 // API Stubs
 VERSION("1.0.0")
@@ -142,7 +157,8 @@ char* aidaRequestString(JNIEnv* env, const char* uri, Arguments arguments) {
 }
 
 /**
- * Implement Correlated Plots
+ * Implement Correlated Plots.  `TRIGGERGET:TACT` and `FBCKGET:LOOP_STAT` instead return the statuses of many
+ * trigger devices or feedback loops, see getTrigStatuses() and getFaStatuses()
  *
  * @param env to be used to throw exceptions using aidaThrow() and aidaThrowNonOsException()
  * @param uri the uri
@@ -160,118 +176,311 @@ char* aidaRequestString(JNIEnv* env, const char* uri, Arguments arguments) {
  * 		`samp{n}`			FLOAT_ARRAY		For each sample variable found in the given FILE a column is returned.  {n} is the sample var number
  *
  * 	The labels for each column are set to the device name
+ *
+ * If `ASYNC` is given then the scan is submitted as a job and a table with the job's progress is returned at once.
+ * If `STREAM` is given instead then only the latest rows of the job are kept, in a ring of at least
+ * CORRPLOT_RING_ROWS rows, so that the memory used doesn't grow with the number of steps.
+ * The job is then polled with `JOB`, and an optional `ACTION`:
+ * 		`RUN`		run the next `CHUNK` primary steps of the scan, default 2, and return the job's progress.  The default
+ * 		`NEXT`		run the next `CHUNK` primary steps of the scan and return the rows they acquired
+ * 		`STATUS`	return the job's progress
+ * 		`RESULTS`	return the table of the rows acquired so far, or the latest rows if streamed
+ * 		`CANCEL`	stop the scan, the rows acquired so far are kept
+ * A job is kept for `RETENTION` seconds after it was last requested, 300 by default.
+ * As a correlation plot has at least 2 steps, `CHUNK` must be at least 2, and a single step left over at the end
+ * of the scan is run with the chunk before it
  */
 Table aidaRequestTable(JNIEnv* env, const char* uri, Arguments arguments) {
-	REF_DECLARE;
-	DESCR_DECLARE;
+	if (startsWith(uri, "TRIGGERGET")) {
+		return getTrigStatuses(env, arguments);
+	} else if (startsWith(uri, "FBCKGET")) {
+		return getFaStatuses(env, arguments);
+	}
 
 	TRACK_ALLOCATED_MEMORY
 
-	// Blank table
-	Table table;
-	table.columnCount = 0;
-
-	// Get button file name
-	char* buttonFileName;
-	char* primaryStepVariable, * secondaryStepVariable, * magnetFunction;
-	float primaryLow, primaryHigh, primarySettleTime, primaryExtraSettleTime, secondaryLow, secondaryHigh, secondarySettleTime, secondaryExtraSettleTime, settle;
-	int primarySteps, secondarySteps;
-	long nrpos = NRPOS_DEFAULT, dtizavg;
-	short bpmd = BPMD_ROGUE;
-
-	bool secondaryStepVariableProvided = getAcqParameters(env, arguments, &buttonFileName, &primaryStepVariable,
-			&primaryLow, &primaryHigh, &primarySteps,
-			&primaryExtraSettleTime, &primarySettleTime, &secondaryStepVariable, &secondaryLow, &secondaryHigh,
-			&secondarySteps,
-			&secondarySettleTime, &secondaryExtraSettleTime, &bpmd, &nrpos, &dtizavg, &magnetFunction);
-	ON_EXCEPTION_RETURN_(table)
+	// Get job arguments
+	int jobId = 0, chunk = CORRPLOT_CHUNK_DEFAULT;
+	unsigned char async = false, stream = false;
+	float retention = CORRPLOT_JOB_RETENTION_DEFAULT;
+	char* action = NULL;
+
+	if (ascanf(env, &arguments, "%od %ob %ob %od %of %os",
+			"job", &jobId,
+			"async", &async,
+			"stream", &stream,
+			"chunk", &chunk,
+			"retention", &retention,
+			"action", &action
+	)) {
+		RETURN_NULL_TABLE
+	}
+	TRACK_MEMORY(action)
+
+	double now = aidaTimeNow();
+	if (jobId) {
+		// Poll an existing job
+		CorrPlotJob* job = findCorrPlotJob(jobId, now);
+		if (!job) {
+			FREE_MEMORY
+			aidaThrowNonOsException(env, UNABLE_TO_GET_DATA_EXCEPTION, "JOB not recognised, or it has expired");
+			RETURN_NULL_TABLE
+		}
+		job->lastRequested = now;
+
+		if (!action || strcasecmp(action, "RUN") == 0) {
+			FREE_MEMORY
+			if (runCorrPlotJob(env, job)) {
+				RETURN_NULL_TABLE
+			}
+			return corrPlotJobStatusTable(env, job);
+		} else if (strcasecmp(action, "NEXT") == 0) {
+			FREE_MEMORY
+			int firstRow = job->rows;
+			if (job->state != CORRPLOT_JOB_RUNNING) {
+				aidaThrowNonOsException(env, UNABLE_TO_GET_DATA_EXCEPTION, "JOB has no more steps to run");
+				RETURN_NULL_TABLE
+			}
+			if (runCorrPlotJob(env, job)) {
+				RETURN_NULL_TABLE
+			}
+			return corrPlotJobTable(env, job, firstRow, job->rows - firstRow);
+		} else if (strcasecmp(action, "STATUS") == 0) {
+			FREE_MEMORY
+			return corrPlotJobStatusTable(env, job);
+		} else if (strcasecmp(action, "RESULTS") == 0) {
+			FREE_MEMORY
+			int nRows = job->rows < job->capacity ? job->rows : job->capacity;
+			return corrPlotJobTable(env, job, job->rows - nRows, nRows);
+		} else if (strcasecmp(action, "CANCEL") == 0) {
+			FREE_MEMORY
+			if (job->state == CORRPLOT_JOB_RUNNING) {
+				job->state = CORRPLOT_JOB_CANCELLED;
+			}
+			return corrPlotJobStatusTable(env, job);
+		}
+		FREE_MEMORY
+		aidaThrowNonOsException(env, UNABLE_TO_GET_DATA_EXCEPTION,
+				"ACTION must be one of RUN, NEXT, STATUS, RESULTS, or CANCEL");
+		RETURN_NULL_TABLE
+	}
+	FREE_MEMORY
+
+	if (chunk < 2) {
+		aidaThrowNonOsException(env, UNABLE_TO_GET_DATA_EXCEPTION, "CHUNK must be at least 2");
+		RETURN_NULL_TABLE
+	}
+	if (retention <= 0.0f) {
+		aidaThrowNonOsException(env, UNABLE_TO_GET_DATA_EXCEPTION, "RETENTION must be positive");
+		RETURN_NULL_TABLE
+	}
+
+	// Get the scan
+	CorrPlotJob request;
+	memset(&request, 0, sizeof(request));
+	if (getCorrPlotScan(env, arguments, &request.scan)) {
+		RETURN_NULL_TABLE
+	}
+	request.state = CORRPLOT_JOB_RUNNING;
+	request.retention = retention;
+	request.lastRequested = now;
+
+	if (async || stream) {
+		// Submit the scan as a job, it is run as it is polled
+		request.chunk = chunk;
+		request.stream = stream;
+		CorrPlotJob* job = newCorrPlotJob(env, &request);
+		if (!job) {
+			RETURN_NULL_TABLE
+		}
+		return corrPlotJobStatusTable(env, job);
+	}
+
+	// Run the whole scan now
+	request.chunk = request.scan.primarySteps;
+	if (runCorrPlotJob(env, &request)) {
+		free(request.variables);
+		RETURN_NULL_TABLE
+	}
+	Table table = corrPlotJobTable(env, &request, 0, request.rows);
+	free(request.variables);
+	return table;
+}
+
+/**
+ * Get the parameters of a correlation plot scan from the arguments
+ *
+ * @param env to be used to throw exceptions using aidaThrow() and aidaThrowNonOsException()
+ * @param arguments the arguments
+ * @param scan the scan to store the parameters in
+ * @return EXIT_SUCCESS if all went well
+ */
+static int getCorrPlotScan(JNIEnv* env, Arguments arguments, CorrPlotScan* scan) {
+	TRACK_ALLOCATED_MEMORY
+	char* buttonFileName = NULL, * primaryStepVariable = NULL, * secondaryStepVariable = NULL, * magnetFunction = NULL;
+
+	scan->nrpos = NRPOS_DEFAULT;
+	scan->bpmd = BPMD_ROGUE;
+	scan->secondaryStepVariableProvided = getAcqParameters(env, arguments, &buttonFileName, &primaryStepVariable,
+			&scan->primaryLow, &scan->primaryHigh, &scan->primarySteps,
+			&scan->primaryExtraSettleTime, &scan->primarySettleTime, &secondaryStepVariable, &scan->secondaryLow,
+			&scan->secondaryHigh, &scan->secondarySteps,
+			&scan->secondarySettleTime, &scan->secondaryExtraSettleTime, &scan->bpmd, &scan->nrpos, &scan->dtizavg,
+			&magnetFunction);
 	TRACK_MEMORY(buttonFileName)
 	TRACK_MEMORY(primaryStepVariable)
 	TRACK_MEMORY(secondaryStepVariable)
+	TRACK_MEMORY(magnetFunction)
+	ON_EXCEPTION_FREE_MEMORY_AND_RETURN_(EXIT_FAILURE)
+
+	if (strlen(buttonFileName) >= CORRPLOT_NAME_LEN - strlen(SLC_BUTTON_DIR)
+			|| strlen(primaryStepVariable) >= CORRPLOT_NAME_LEN
+			|| (secondaryStepVariable && strlen(secondaryStepVariable) >= CORRPLOT_NAME_LEN)) {
+		FREE_MEMORY
+		aidaThrowNonOsException(env, UNABLE_TO_GET_DATA_EXCEPTION, "FILE or step variable name is too long");
+		return EXIT_FAILURE;
+	}
 
+	strcpy(scan->buttonFileName, buttonFileName);
+	strcpy(scan->primaryStepVariable, primaryStepVariable);
+	strcpy(scan->secondaryStepVariable, secondaryStepVariable ? secondaryStepVariable : "");
+	strncpy(scan->magnetFunction, magnetFunction ? magnetFunction : "", sizeof(scan->magnetFunction) - 1);
+	FREE_MEMORY
+	return EXIT_SUCCESS;
+}
+
+/**
+ * Run the next chunk of primary steps of a correlation plot job, adding the rows acquired to the job.
+ * A single primary step left over after the chunk is run with it, so that every chunk is a correlation plot
+ * of at least 2 steps.  The job's state is set to complete when all its primary steps have been run,
+ * or failed if they can't be run
+ *
+ * @param env to be used to throw exceptions using aidaThrow() and aidaThrowNonOsException()
+ * @param job the job
+ * @return EXIT_SUCCESS if all went well
+ */
+static int runCorrPlotJob(JNIEnv* env, CorrPlotJob* job) {
+	if (job->state != CORRPLOT_JOB_RUNNING) {
+		return EXIT_SUCCESS;
+	}
+
+	int nSteps = job->scan.primarySteps - job->stepsDone;
+	if (nSteps > job->chunk + 1) {
+		nSteps = job->chunk;
+	}
+
+	if (runCorrPlotSteps(env, job, job->stepsDone, nSteps)) {
+		job->state = CORRPLOT_JOB_FAILED;
+		return EXIT_FAILURE;
+	}
+
+	job->stepsDone += nSteps;
+	if (job->stepsDone >= job->scan.primarySteps) {
+		job->state = CORRPLOT_JOB_COMPLETE;
+	}
+	return EXIT_SUCCESS;
+}
+
+/**
+ * Run the given primary steps of a correlation plot scan, with all the secondary steps at each,
+ * and add the rows acquired to the job
+ *
+ * @param env to be used to throw exceptions using aidaThrow() and aidaThrowNonOsException()
+ * @param job the job
+ * @param firstStep the first primary step to run, from 0
+ * @param nSteps the number of primary steps to run
+ * @return EXIT_SUCCESS if all went well
+ */
+static int runCorrPlotSteps(JNIEnv* env, CorrPlotJob* job, int firstStep, int nSteps) {
+	REF_DECLARE;
+	DESCR_DECLARE;
+
+	TRACK_ALLOCATED_MEMORY
+
+	CorrPlotScan* scan = &job->scan;
 	vmsstat_t status;
 
 	// Initialize correlation plot context
 	status = CRR_RESET_ALL();
 	if (!SUCCESS(status)) {
 		SPRINTF_ERROR_STATUS_FREE_MEMORY_AND_RETURN_(status, UNABLE_TO_GET_DATA_EXCEPTION,
-				"error resetting correlation plots: %s", buttonFileName, table)
+				"error resetting correlation plots: %s", scan->buttonFileName, EXIT_FAILURE)
 	}
 
-	// Local constant for fortran parameter
-	float wire_size = 0.0f;
-	float inc = (primaryHigh - primaryLow) / (float)(primarySteps - 1);
-
-	// Set up primary step variable
-	status = CRR_SET_VAR_NAME_FREEFORM(REFINT4_1(DEFINE_STEP), REFINT4_2(1), DESCRN1(primaryStepVariable),
+	// Set up primary step variable, starting from the first step to run
+	float inc = (scan->primaryHigh - scan->primaryLow) / (float)(scan->primarySteps - 1);
+	float low = scan->primaryLow + (float)firstStep * inc;
+	status = CRR_SET_VAR_NAME_FREEFORM(REFINT4_1(DEFINE_STEP), REFINT4_2(1), DESCRN1(scan->primaryStepVariable),
 			REFINT4_3(0));
 	if (!SUCCESS(status)) {
 		SPRINTF_ERROR_STATUS_FREE_MEMORY_AND_RETURN_(status, UNABLE_TO_GET_DATA_EXCEPTION,
-				"error setting primary step variable name: %s", primaryStepVariable, table)
+				"error setting primary step variable name: %s", scan->primaryStepVariable, EXIT_FAILURE)
 	}
-	status = CRR_SET_STEP(REFINT4_1(1), &primaryLow, &inc, &primarySteps, &primarySettleTime);
+	status = CRR_SET_STEP(REFINT4_1(1), &low, &inc, &nSteps, &scan->primarySettleTime);
 	if (!SUCCESS(status)) {
 		SPRINTF_ERROR_STATUS_FREE_MEMORY_AND_RETURN_(status, UNABLE_TO_GET_DATA_EXCEPTION,
-				"error setting primary step variable: %s", primaryStepVariable, table)
+				"error setting primary step variable: %s", scan->primaryStepVariable, EXIT_FAILURE)
 	}
 
 	// Set secondary step variable
-	if (secondaryStepVariableProvided) {
-		status = CRR_SET_VAR_NAME_FREEFORM(REFINT4_1(DEFINE_STEP), REFINT4_2(-1), DESCRN1(secondaryStepVariable),
-				REFINT4_3(0));
+	if (scan->secondaryStepVariableProvided) {
+		status = CRR_SET_VAR_NAME_FREEFORM(REFINT4_1(DEFINE_STEP), REFINT4_2(-1),
+				DESCRN1(scan->secondaryStepVariable), REFINT4_3(0));
 		if (!SUCCESS(status)) {
 			SPRINTF_ERROR_STATUS_FREE_MEMORY_AND_RETURN_(status, UNABLE_TO_GET_DATA_EXCEPTION,
-					"error setting secondary step variable name: %s", secondaryStepVariable, table)
+					"error setting secondary step variable name: %s", scan->secondaryStepVariable, EXIT_FAILURE)
 		}
 
-		inc = (secondaryHigh - secondaryLow) / (float)(secondarySteps - 1);
-		status = CRR_SET_STEP(REFINT4_1(-1), &secondaryLow, &inc, &secondarySteps, &secondarySettleTime);
+		inc = (scan->secondaryHigh - scan->secondaryLow) / (float)(scan->secondarySteps - 1);
+		status = CRR_SET_STEP(REFINT4_1(-1), &scan->secondaryLow, &inc, &scan->secondarySteps,
+				&scan->secondarySettleTime);
 		if (!SUCCESS(status)) {
 			SPRINTF_ERROR_STATUS_FREE_MEMORY_AND_RETURN_(status, UNABLE_TO_GET_DATA_EXCEPTION,
-					"error setting secondary step variable: %s", secondaryStepVariable, table)
+					"error setting secondary step variable: %s", scan->secondaryStepVariable, EXIT_FAILURE)
 		}
 	}
 
 	// Make absolute file name
-	char fullyQualifiedButtonFileName[strlen(buttonFileName) + strlen(SLC_BUTTON_DIR) + 1];
-	sprintf(fullyQualifiedButtonFileName, "%s%s", SLC_BUTTON_DIR, buttonFileName);
+	char fullyQualifiedButtonFileName[CORRPLOT_NAME_LEN];
+	sprintf(fullyQualifiedButtonFileName, "%s%s", SLC_BUTTON_DIR, scan->buttonFileName);
 
 	// Load button file
 	status = CRR_RESTORE_BUTTON_FILE(DESCRN1(fullyQualifiedButtonFileName));
 	if (!SUCCESS(status)) {
 		SPRINTF_ERROR_STATUS_FREE_MEMORY_AND_RETURN_(status, UNABLE_TO_GET_DATA_EXCEPTION,
-				"error loading scan parameters from button file: %s", fullyQualifiedButtonFileName, table)
+				"error loading scan parameters from button file: %s", fullyQualifiedButtonFileName, EXIT_FAILURE)
 	}
 
 	// Set BPM Measurement Definition if it has been specified
-	if (bpmd != BPMD_ROGUE) {
-		status = BPMD_SELECT_UTIL(&bpmd, NULL, NULL, NULL, NULL, NULL);
+	if (scan->bpmd != BPMD_ROGUE) {
+		status = BPMD_SELECT_UTIL(&scan->bpmd, NULL, NULL, NULL, NULL, NULL);
 		if (!SUCCESS(status)) {
-			fprintf(stderr, "Failed to set Measurement Definition: %hd", bpmd);
+			fprintf(stderr, "Failed to set Measurement Definition: %hd", scan->bpmd);
 			SPRINTF_ERROR_STATUS_FREE_MEMORY_AND_RETURN_(status, UNABLE_TO_GET_DATA_EXCEPTION,
-					"error initializing correlation plot acquisition: %s", buttonFileName, table)
+					"error initializing correlation plot acquisition: %s", scan->buttonFileName, EXIT_FAILURE)
 		}
 	}
 
-	long magfunc;
-	memcpy(&magfunc, magnetFunction, 4);
+	long magfunc = 0;
+	memcpy(&magfunc, scan->magnetFunction, strlen(scan->magnetFunction));
 	float settleExtra[2];
-	settleExtra[0] = primaryExtraSettleTime;
-	settleExtra[1] = secondaryExtraSettleTime;
+	settleExtra[0] = scan->primaryExtraSettleTime;
+	settleExtra[1] = scan->secondaryExtraSettleTime;
 
-	status = CRR_SET_SAMP_PARMS(&nrpos, &dtizavg, NULL, &magfunc, NULL, NULL, NULL, &settleExtra[0]);
+	status = CRR_SET_SAMP_PARMS(&scan->nrpos, &scan->dtizavg, NULL, scan->magnetFunction[0] ? &magfunc : NULL,
+			NULL, NULL, NULL, &settleExtra[0]);
 	if (!SUCCESS(status)) {
 		fprintf(stderr,
 				"Failed to set sample params.  nrpos: %ld, dtizavg: %ld,  magfunc: %ld,  primSettleExtra: %f,  secnSettleExtra: %f",
-				nrpos, dtizavg, magfunc, settleExtra[0], settleExtra[1]);
+				scan->nrpos, scan->dtizavg, magfunc, settleExtra[0], settleExtra[1]);
 		SPRINTF_ERROR_STATUS_FREE_MEMORY_AND_RETURN_(status, UNABLE_TO_GET_DATA_EXCEPTION,
-				"error initializing correlation plot acquisition: %s", buttonFileName, table)
+				"error initializing correlation plot acquisition: %s", scan->buttonFileName, EXIT_FAILURE)
 	}
 
 	status = CRR_DATA_ACQ_INIT();
 	if (!SUCCESS(status)) {
 		SPRINTF_ERROR_STATUS_FREE_MEMORY_AND_RETURN_(status, UNABLE_TO_GET_DATA_EXCEPTION,
-				"error initializing correlation plot acquisition: %s", buttonFileName, table)
+				"error initializing correlation plot acquisition: %s", scan->buttonFileName, EXIT_FAILURE)
 	}
 
 	// Run Correlation plot
@@ -279,73 +488,174 @@ Table aidaRequestTable(JNIEnv* env, const char* uri, Arguments arguments) {
 	if (!SUCCESS(status)) {
 		CRR_DATA_ACQ_DONE();
 		SPRINTF_ERROR_STATUS_FREE_MEMORY_AND_RETURN_(status, UNABLE_TO_GET_DATA_EXCEPTION,
-				"executing correlation plot: %s", buttonFileName, table)
+				"executing correlation plot: %s", scan->buttonFileName, EXIT_FAILURE)
 	}
-	printf("Scan Complete");
+	printf("Scan Complete: steps %d to %d of %d\n", firstStep + 1, firstStep + nSteps, scan->primarySteps);
 
-	// Number of Samples
-	long nSampleVariables;
-	if (countSampleVariables(env, &nSampleVariables)) {
+	// The variables are found, and space is made for all the rows of the scan, the first time
+	if (!job->variables && getCorrPlotVariables(env, job)) {
 		CRR_DATA_ACQ_DONE();
-		return table;
+		return EXIT_FAILURE;
 	}
 
 	// Get step count.
-	int nSteps = CRR_SAMPLES();
-	if (!SUCCESS(status)) {
+	int nRows = CRR_SAMPLES();
+	if (!nRows) {
 		CRR_DATA_ACQ_DONE();
 		SPRINTF_ERROR_FREE_MEMORY_AND_RETURN_(UNABLE_TO_GET_DATA_EXCEPTION,
-				"error getting number of steps: %s", buttonFileName, table)
+				"Total number of steps derived from specified step variables is: %s", "0", EXIT_FAILURE)
+	}
+	long ringRow = job->rows % job->capacity;
+	if (nRows < 0 || ringRow + nRows > job->capacity) {
+		CRR_DATA_ACQ_DONE();
+		SPRINTF_ERROR_FREE_MEMORY_AND_RETURN_(UNABLE_TO_GET_DATA_EXCEPTION,
+				"more steps were acquired than specified: %s", scan->buttonFileName, EXIT_FAILURE)
+	}
+
+	// Clean up correlation plot context.  The acquired values are got afterwards, in the order always used
+	status = CRR_DATA_ACQ_DONE();
+	if (!SUCCESS(status)) {
+		SPRINTF_ERROR_STATUS_FREE_MEMORY_AND_RETURN_(status, UNABLE_TO_GET_DATA_EXCEPTION,
+				"cleaning up after correlation plot: %s", scan->buttonFileName, EXIT_FAILURE)
+	}
+
+	// Add the rows acquired to those of the earlier steps, over the oldest if streamed
+	printf("Tabulating Scan Results: %d x %d\n", nRows, job->nVariables);
+	for (int i = 0; i < job->nVariables; i++) {
+		CorrPlotVariable* variable = &job->variables[i];
+		long offset = (long)i * job->capacity + ringRow;
+		if (variable->noErrors) {
+			status = CRR_GET_VAR(&variable->varNum, &job->values[offset], NULL, NULL, NULL);
+		} else {
+			status = CRR_GET_VAR(&variable->varNum, &job->values[offset], &job->errors[offset], &job->oks[offset],
+					NULL);
+		}
+		if (!SUCCESS(status)) {
+			aidaThrow(env, status, UNABLE_TO_GET_DATA_EXCEPTION, "unable to get sample data");
+			return EXIT_FAILURE;
+		}
+	}
+	job->rows += nRows;
+
+	return EXIT_SUCCESS;
+}
+
+/**
+ * Find the step and sample variables of the correlation plot that has just been acquired,
+ * and make space in the job for all the rows of the scan, or just the ring of latest rows if it is streamed
+ *
+ * @param env to be used to throw exceptions using aidaThrow() and aidaThrowNonOsException()
+ * @param job the job
+ * @return EXIT_SUCCESS if all went well
+ */
+static int getCorrPlotVariables(JNIEnv* env, CorrPlotJob* job) {
+	REF_DECLARE;
+	CorrPlotScan* scan = &job->scan;
+
+	// Number of Samples
+	long nSampleVariables;
+	if (countSampleVariables(env, &nSampleVariables)) {
+		return EXIT_FAILURE;
 	}
 
 	// Get total number of samples
-	long totalSampleVariables = nSampleVariables + ((secondaryStepVariableProvided) ? 2 : 1);
-	if (!totalSampleVariables || !nSampleVariables) {
-		CRR_DATA_ACQ_DONE();
+	int secondaryAdjust = (scan->secondaryStepVariableProvided ? 1 : 0);
+	long totalSampleVariables = nSampleVariables + 1 + secondaryAdjust;
+	if (!nSampleVariables) {
 		fprintf(stderr, "Invalid number of sample variables. totalSampleVariables: %ld, nSampleVariables: %ld",
 				totalSampleVariables, nSampleVariables);
-		SPRINTF_ERROR_FREE_MEMORY_AND_RETURN_(UNABLE_TO_GET_DATA_EXCEPTION,
-				"No sample variables have been specified in the given file: %s", buttonFileName, table)
+		char error[MAX_ERROR_TEXT_LEN + CORRPLOT_NAME_LEN];
+		sprintf(error, "No sample variables have been specified in the given file: %s", scan->buttonFileName);
+		aidaThrowNonOsException(env, UNABLE_TO_GET_DATA_EXCEPTION, error);
+		return EXIT_FAILURE;
 	}
 
-	// Query results variables
-	if (!nSteps) {
-		CRR_DATA_ACQ_DONE();
-		SPRINTF_ERROR_FREE_MEMORY_AND_RETURN_(UNABLE_TO_GET_DATA_EXCEPTION,
-				"Total number of steps derived from specified step variables is: %s", "0", table)
+	// One block for the variables, then their values, errors, and oks, for all the rows of the scan.
+	// A streamed job's ring is a whole number of chunks so that no chunk wraps around it.  If a single step left
+	// over is run with the last chunk then the ring has a chunk more if need be, so that the last chunk doesn't wrap
+	int rowsPerStep = scan->secondaryStepVariableProvided ? scan->secondarySteps : 1;
+	int capacity = scan->primarySteps * rowsPerStep;
+	if (job->stream) {
+		int chunkRows = job->chunk * rowsPerStep;
+		int ringChunks = CORRPLOT_RING_ROWS / chunkRows > 1 ? CORRPLOT_RING_ROWS / chunkRows : 1;
+		int nChunks = scan->primarySteps / job->chunk;
+		while (scan->primarySteps % job->chunk == 1 && nChunks % ringChunks == 0) {
+			ringChunks++;
+		}
+		int ringRows = chunkRows * ringChunks;
+		if (ringRows < capacity) {
+			capacity = ringRows;
+		}
+	}
+	size_t columnSize = (size_t)totalSampleVariables * capacity;
+	CorrPlotVariable* variables = ALLOCATE_MEMORY(env, totalSampleVariables * sizeof(CorrPlotVariable)
+			+ columnSize * (2 * sizeof(float) + sizeof(long)), "store acquired data");
+	if (!variables) {
+		return EXIT_FAILURE;
 	}
 
-	// Space for samples.  Organised as sets of values for all sample variables
-	float* samples;
-	long* samplesOk;
+	vmsstat_t status;
+	int nVariables = 0;
+	for (long varNum = -secondaryAdjust; nVariables < totalSampleVariables; varNum++) {
+		long prim, micr, unit, secn, secn2, elem2;
+		status = CRR_GET_VAR_NAME(REFINT4_1(DEFINE_SAMPLE), &varNum, &prim, &micr, &unit, &secn, &secn2, &elem2);
 
-	printf("Tabulating Scan Results: %d x %ld\n", nSteps, totalSampleVariables);
-	ALLOCATE_AND_TRACK_MEMORY_AND_ON_ERROR_RETURN_(env, samples, nSteps * totalSampleVariables * sizeof(float) * 2,
-			"store acquired data", table)
-	ALLOCATE_AND_TRACK_MEMORY_AND_ON_ERROR_RETURN_(env, samplesOk, nSteps * totalSampleVariables * sizeof(long),
-			"store acquired data ok", table)
+		CorrPlotVariable* variable = &variables[nVariables];
+		variable->varNum = varNum;
+		variable->noErrors = prim == TIME_SV || prim == ATIME_SV || prim == SAMP_SV;
 
-	// Clean up correlation plot context
-	status = CRR_DATA_ACQ_DONE();
-	if (!SUCCESS(status)) {
-		SPRINTF_ERROR_STATUS_FREE_MEMORY_AND_RETURN_(status, UNABLE_TO_GET_DATA_EXCEPTION,
-				"cleaning up after correlation plot: %s", buttonFileName, table)
-	}
+		if (varNum == 0) { // Primary step variable
+			strcpy(variable->field, "primary");
+			strcpy(variable->label, scan->primaryStepVariable);
+		} else if (varNum == -1) {
+			strcpy(variable->field, "secondary");
+			strcpy(variable->label, scan->secondaryStepVariable);
+		} else {
+			if (!SUCCESS(status)) {
+				free(variables);
+				aidaThrow(env, status, UNABLE_TO_GET_DATA_EXCEPTION, "unable to get var name");
+				return EXIT_FAILURE;
+			}
 
-	// Allocate a dynamic table of with as many columns as samples and step variables
-	table = tableCreateDynamic(env, nSteps, (int)totalSampleVariables * 3);
-	ON_EXCEPTION_FREE_MEMORY_AND_RETURN_(table)
+			if (prim == ZERO_SV) {
+				continue;
+			}
 
-	// Create the correlation plot table
-	createCorrelationPlotTable(env, &table, ((int)totalSampleVariables), nSteps,
-			primaryStepVariable,
-			secondaryStepVariableProvided, secondaryStepVariable,
-			samples, samplesOk);
+			sprintf(variable->field, "sample%ld", varNum);
 
-	// Free all allocated memory
-	FREE_MEMORY
+			unsigned long rawName[AP_DESCSIZE];
+			CRR_GET_VAR_DEF(REFINT4_1(DEFINE_SAMPLE), &varNum, (long*)&rawName[0]);
+			char part[10];
+			char* label = variable->label;
+			sprintf(label, "%.4s", (char*)&rawName[0]);
+			sprintf(part, "%.4s", (char*)&rawName[1]);
+			if (part[0] != '-') {
+				sprintf(label + strlen(label), ":%.4s", part);
+				sprintf(part, "%.4s", (char*)&rawName[2]);
+				if (part[0] != '-') {
+					sprintf(label + strlen(label), ":%.4s", part);
+					sprintf(part, "%.4s", (char*)&rawName[3]);
+					if (part[0] != '-') {
+						sprintf(label + strlen(label), ":%.4s", part);
+						sprintf(part, "%.4s", (char*)&rawName[4]);
+						if (part[0] != '-') {
+							sprintf(label + strlen(label), " %.4s", part);
+						}
+					}
+				}
+			}
+		}
 
-	return table;
+		nVariables++;
+	}
+
+	job->variables = variables;
+	job->nVariables = nVariables;
+	job->capacity = capacity;
+	job->values = (float*)(variables + nVariables);
+	job->errors = job->values + columnSize;
+	job->oks = (long*)(job->errors + columnSize);
+	return EXIT_SUCCESS;
 }
 
 /**
@@ -381,135 +691,221 @@ static int countSampleVariables(JNIEnv* env, long* nSampleVariables) {
 }
 
 /**
- * Add the provided samples to the given table and create the fields, and labels as well
+ * Make a table of the given rows a correlation plot job has acquired, with the fields and labels
+ * of its step and sample variables
  *
  * @param env to be used to throw exceptions using aidaThrow() and aidaThrowNonOsException()
- * @param table given table
- * @param totalSampleVariables the total number of samples for which the scan was done
- * @param nSteps the number of steps over which the plot was executed
- * @param primaryStepVariable the name of the primary step variable
- * @param secondaryStepVariableProvided true if a secondary step variable was provided
- * @param secondaryStepVariable the secondary step variable
- * @param sampleDescriptors the sample descriptors in for of longs representing PRIM, MICRO, UNIT, SECN
- * @param samples array of sample values organised as vectors
- */
-static void createCorrelationPlotTable(JNIEnv* env, Table* table, int totalSampleVariables, int nSteps,
-		char* primaryStepVariable, bool secondaryStepVariableProvided, char* secondaryStepVariable,
-		float* samples, long* samplesOk) {
-	REF_DECLARE;
-	char name[MAX_URI_LEN];
-	char sampleFieldName[MAX_URI_LEN + 1], sampleLabelName[MAX_URI_LEN + 1];
+ * @param job the job
+ * @param firstRow the first row, the job must still hold it
+ * @param nRows the number of rows
+ * @return the table
+ */
+static Table corrPlotJobTable(JNIEnv* env, CorrPlotJob* job, int firstRow, int nRows) {
+	char name[CORRPLOT_NAME_LEN + 8];
 
-	char* tableFieldName, * tableLabelName;
-	int secondaryAdjust = (secondaryStepVariableProvided ? 1 : 0);
-	vmsstat_t status;
-	int samplesAdded = 0;
-	for (long varNum = -secondaryAdjust; samplesAdded < totalSampleVariables; varNum++) {
-		bool isTime = false, isATime = false, isSamp = false;
-		long prim, micr, unit, secn, secn2, elem2;
-		status = CRR_GET_VAR_NAME(REFINT4_1(DEFINE_SAMPLE), &varNum, &prim, &micr, &unit, &secn, &secn2, &elem2);
-		isTime = prim == TIME_SV;
-		isATime = prim == ATIME_SV;
-		isSamp = prim == SAMP_SV;
+	if (nRows <= 0) {
+		aidaThrowNonOsException(env, UNABLE_TO_GET_DATA_EXCEPTION, "No rows have been acquired for this JOB yet");
+		RETURN_NULL_TABLE
+	}
 
-		if (varNum == 0) { // Primary step variable
-			tableFieldName = "primary";
-			tableLabelName = primaryStepVariable;
-		} else if (varNum == -1) {
-			tableFieldName = "secondary";
-			tableLabelName = secondaryStepVariable;
+	int nColumns = 0;
+	for (int i = 0; i < job->nVariables; i++) {
+		nColumns += job->variables[i].noErrors ? 1 : 3;
+	}
+
+	// Rows that wrap around a streamed job's ring are put back in order, a column at a time
+	int ringRow = firstRow % job->capacity, nWrapped = ringRow + nRows - job->capacity;
+	void* column = NULL;
+	if (nWrapped > 0) {
+		column = ALLOCATE_MEMORY(env, nRows * (sizeof(long) > sizeof(float) ? sizeof(long) : sizeof(float)),
+				"correlation plot column");
+		if (!column) {
+			RETURN_NULL_TABLE
+		}
+	}
+
+	// Allocate a dynamic table of with as many columns as samples and step variables
+	Table table = tableCreateDynamic(env, nRows, nColumns);
+	for (int i = 0; i < job->nVariables && !(*env)->ExceptionCheck(env); i++) {
+		CorrPlotVariable* variable = &job->variables[i];
+		long offset = (long)i * job->capacity + ringRow;
+
+		// Data column
+		void* data = corrPlotJobColumn(column, &job->values[offset], &job->values[offset - ringRow],
+				sizeof(float), nRows, nWrapped);
+		if (variable->noErrors) {
+			tableAddColumn(env, &table, AIDA_LONG_TYPE, data, false);
 		} else {
-			if (!SUCCESS(status)) {
-				aidaThrow(env, status, UNABLE_TO_GET_DATA_EXCEPTION, "unable to get var name");
-				return;
+			tableAddColumn(env, &table, AIDA_FLOAT_TYPE, data, true);
+		}
+		if (!(*env)->ExceptionCheck(env)) {
+			tableAddField(env, &table, variable->field);
+		}
+		if (!(*env)->ExceptionCheck(env)) {
+			tableAddLabel(env, &table, variable->label);
+		}
+
+		if (!variable->noErrors && !(*env)->ExceptionCheck(env)) {
+			// Error column
+			data = corrPlotJobColumn(column, &job->errors[offset], &job->errors[offset - ringRow],
+					sizeof(float), nRows, nWrapped);
+			tableAddColumn(env, &table, AIDA_FLOAT_TYPE, data, true);
+			sprintf(name, "%sError", variable->field);
+			if (!(*env)->ExceptionCheck(env)) {
+				tableAddField(env, &table, name);
+			}
+			sprintf(name, "%s Error", variable->label);
+			if (!(*env)->ExceptionCheck(env)) {
+				tableAddLabel(env, &table, name);
 			}
 
-			if (prim == ZERO_SV) {
-				continue;
+			// Data OK column
+			data = corrPlotJobColumn(column, &job->oks[offset], &job->oks[offset - ringRow],
+					sizeof(long), nRows, nWrapped);
+			if (!(*env)->ExceptionCheck(env)) {
+				tableAddColumn(env, &table, AIDA_LONG_TYPE, data, false);
 			}
+			sprintf(name, "%sOk", variable->field);
+			if (!(*env)->ExceptionCheck(env)) {
+				tableAddField(env, &table, name);
+			}
+			sprintf(name, "%s Ok?", variable->label);
+			if (!(*env)->ExceptionCheck(env)) {
+				tableAddLabel(env, &table, name);
+			}
+		}
+	}
 
-			sprintf(sampleFieldName, "sample%ld", varNum);
-			tableFieldName = sampleFieldName;
+	free(column);
+	return table;
+}
 
-			unsigned long rawName[AP_DESCSIZE];
-			CRR_GET_VAR_DEF(REFINT4_1(DEFINE_SAMPLE), &varNum, (long*)&rawName[0]);
-			char part[10];
-//			struct dsc$descriptor desc = AP_DEV_TO_STR(&rawName[0]);
-//			tableLabelName = desc.dsc$a_pointer;
-//			sprintf(sampleLabelName, "sample%ld", varNum);
-			sprintf(sampleLabelName, "%.4s", (char*)&rawName[0]);
-			sprintf(part, "%.4s", (char*)&rawName[1]);
-			if (part[0] != '-') {
-				sprintf(sampleLabelName + strlen(sampleLabelName), ":%.4s", part);
-				sprintf(part, "%.4s", (char*)&rawName[2]);
-				if (part[0] != '-') {
-					sprintf(sampleLabelName + strlen(sampleLabelName), ":%.4s", part);
-					sprintf(part, "%.4s", (char*)&rawName[3]);
-					if (part[0] != '-') {
-						sprintf(sampleLabelName + strlen(sampleLabelName), ":%.4s", part);
-						sprintf(part, "%.4s", (char*)&rawName[4]);
-						if (part[0] != '-') {
-							sprintf(sampleLabelName + strlen(sampleLabelName), " %.4s", part);
-						}
-					}
-				}
-			}
-			tableLabelName = sampleLabelName;
+/**
+ * Get the given rows of a column of a correlation plot job, in order
+ *
+ * @param column space for the rows if they wrap around the job's ring
+ * @param first the first row in the ring
+ * @param ringStart the start of the column's ring
+ * @param elementSize the size of each row's value
+ * @param nRows the number of rows
+ * @param nWrapped the number of rows that wrap around to the start of the ring
+ * @return the rows in order
+ */
+static void* corrPlotJobColumn(void* column, void* first, void* ringStart, size_t elementSize, int nRows,
+		int nWrapped) {
+	if (nWrapped <= 0) {
+		return first;
+	}
+	memcpy(column, first, (nRows - nWrapped) * elementSize);
+	memcpy((char*)column + (nRows - nWrapped) * elementSize, ringStart, nWrapped * elementSize);
+	return column;
+}
+
+/**
+ * Make a one row table of the progress of a correlation plot job
+ *
+ * @param env to be used to throw exceptions using aidaThrow() and aidaThrowNonOsException()
+ * @param job the job
+ * @return the table
+ */
+static Table corrPlotJobStatusTable(JNIEnv* env, CorrPlotJob* job) {
+	char* states[] = { "running", "complete", "cancelled", "failed" };
+	char* fields[] = { "job", "state", "step", "steps", "rows" };
+	char* labels[] = { "Job", "State", "Primary steps run", "Primary steps", "Rows acquired" };
+
+	Table table = tableCreateDynamic(env, 1, 5);
+	ON_EXCEPTION_RETURN_(table)
+	tableAddSingleRowIntegerColumn(env, &table, job->id);
+	ON_EXCEPTION_RETURN_(table)
+	tableAddSingleRowStringColumn(env, &table, states[job->state - CORRPLOT_JOB_RUNNING]);
+	ON_EXCEPTION_RETURN_(table)
+	tableAddSingleRowIntegerColumn(env, &table, job->stepsDone);
+	ON_EXCEPTION_RETURN_(table)
+	tableAddSingleRowIntegerColumn(env, &table, job->scan.primarySteps);
+	ON_EXCEPTION_RETURN_(table)
+	tableAddSingleRowIntegerColumn(env, &table, job->rows);
+	ON_EXCEPTION_RETURN_(table)
+
+	for (int column = 0; column < 5 && !(*env)->ExceptionCheck(env); column++) {
+		tableAddField(env, &table, fields[column]);
+		if (!(*env)->ExceptionCheck(env)) {
+			tableAddLabel(env, &table, labels[column]);
 		}
+	}
+	return table;
+}
 
-		// Get sample var data
-		long dataOffset = table->_currentColumn * nSteps;
-		long errorOffset = dataOffset + nSteps;
-		if (isTime || isATime || isSamp) {
-			status = CRR_GET_VAR(&varNum, &samples[dataOffset], NULL, NULL, NULL);
-		} else {
-			status = CRR_GET_VAR(&varNum, &samples[dataOffset], &samples[errorOffset], &samplesOk[dataOffset], NULL);
+/**
+ * Find the correlation plot job with the given id, releasing any expired jobs on the way
+ *
+ * @param jobId the job id
+ * @param now the time now, in seconds
+ * @return the job or NULL if there is none
+ */
+static CorrPlotJob* findCorrPlotJob(int jobId, double now) {
+	CorrPlotJob* found = NULL;
+
+	for (int i = 0; i < MAX_CORRPLOT_JOBS; i++) {
+		CorrPlotJob* job = &corrPlotJobs[i];
+		if (job->id && now - job->lastRequested > job->retention) {
+			releaseCorrPlotJob(job);
 		}
-		if (!SUCCESS(status)) {
-			aidaThrow(env, status, UNABLE_TO_GET_DATA_EXCEPTION, "unable to get sample data");
-			return;
+		if (job->id && job->id == jobId) {
+			found = job;
 		}
+	}
 
-		// Data column
-		if (isTime || isATime) {
-			tableAddColumn(env, table, AIDA_LONG_TYPE, &samples[dataOffset], false);
-		} else if (isSamp) {
-			tableAddColumn(env, table, AIDA_LONG_TYPE, &samples[dataOffset], false);
-		} else {
-			tableAddColumn(env, table, AIDA_FLOAT_TYPE, &samples[dataOffset], true);
-		}
-		ON_EXCEPTION_RETURN_VOID
-		tableAddField(env, table, tableFieldName);
-		ON_EXCEPTION_RETURN_VOID
-		tableAddLabel(env, table, tableLabelName);
-		ON_EXCEPTION_RETURN_VOID
-
-		if (isTime || isATime || isSamp) {
-			table->columnCount -= 2;
-		} else {
-			// Error column
-			tableAddColumn(env, table, AIDA_FLOAT_TYPE, &samples[errorOffset], true);
-			ON_EXCEPTION_RETURN_VOID
-			sprintf(name, "%sError", tableFieldName);
-			tableAddField(env, table, name);
-			ON_EXCEPTION_RETURN_VOID
-			sprintf(name, "%s Error", tableLabelName);
-			tableAddLabel(env, table, name);
-			ON_EXCEPTION_RETURN_VOID
+	return found;
+}
 
-			// Data OK column
-			tableAddColumn(env, table, AIDA_LONG_TYPE, &samplesOk[dataOffset], false);
-			ON_EXCEPTION_RETURN_VOID
-			sprintf(name, "%sOk", tableFieldName);
-			tableAddField(env, table, name);
-			ON_EXCEPTION_RETURN_VOID
-			sprintf(name, "%s Ok?", tableLabelName);
-			tableAddLabel(env, table, name);
-			ON_EXCEPTION_RETURN_VOID
+/**
+ * Keep a new correlation plot job, with a new id.  It takes a free job slot, or that of the
+ * least recently requested job that is no longer running if none are free
+ *
+ * @param env to be used to throw exceptions using aidaThrow() and aidaThrowNonOsException()
+ * @param request the job to keep
+ * @return the job, or NULL if all the job slots hold running jobs
+ */
+static CorrPlotJob* newCorrPlotJob(JNIEnv* env, CorrPlotJob* request) {
+	CorrPlotJob* job = NULL;
+
+	findCorrPlotJob(0, request->lastRequested);
+	for (int i = 0; i < MAX_CORRPLOT_JOBS; i++) {
+		if (!corrPlotJobs[i].id) {
+			job = &corrPlotJobs[i];
+			break;
+		}
+		if (corrPlotJobs[i].state != CORRPLOT_JOB_RUNNING
+				&& (!job || corrPlotJobs[i].lastRequested < job->lastRequested)) {
+			job = &corrPlotJobs[i];
 		}
+	}
+
+	if (!job) {
+		aidaThrowNonOsException(env, UNABLE_TO_GET_DATA_EXCEPTION,
+				"Too many correlation plot jobs are running, CANCEL one or wait for one to complete");
+		return NULL;
+	}
+	releaseCorrPlotJob(job);
 
-		samplesAdded++;
+	// Job ids are positive
+	if (++lastCorrPlotJobId <= 0) {
+		lastCorrPlotJobId = 1;
 	}
+
+	*job = *request;
+	job->id = lastCorrPlotJobId;
+	return job;
+}
+
+/**
+ * Release a correlation plot job, and the rows it has acquired
+ *
+ * @param job the job
+ */
+static void releaseCorrPlotJob(CorrPlotJob* job) {
+	free(job->variables);
+	memset(job, 0, sizeof(CorrPlotJob));
 }
 
 /**
@@ -676,7 +1072,8 @@ static void setBGrp(JNIEnv* env, Arguments arguments, Value value) {
 }
 
 /**
- * Set Multi-knob value
+ * Set Multi-knob value.  With SESSION the knob is left assigned, so the next step on the same multiknob file
+ * is just a rotation.  With ENDSESSION the knob session is ended without a rotation
  *
  * @param env
  * @param uri
@@ -697,19 +1094,33 @@ static Table setMkbValue(JNIEnv* env, const char* uri, Arguments arguments, Valu
 	// Get arguments
 	char* mkb;
 	float floatValue;
-	if (avscanf(env, &arguments, &value, "%f %s",
+	bool session = false, endSession = false;
+	if (avscanf(env, &arguments, &value, "%f %s %ob %ob",
 			"value", &floatValue,
-			"mkb", &mkb
+			"mkb", &mkb,
+			"session", &session,
+			"endSession", &endSession
 	)) {
 		RETURN_NULL_TABLE;
 	}
 	TRACK_MEMORY(mkb)
 	CONVERT_TO_VMS_FLOAT(&floatValue, 1)
 
-	// Set the value
+	if (endSession && !DPSLCUTIL_MKB_INSESSION(mkb)) {
+		FREE_MEMORY
+		aidaThrowNonOsException(env, UNABLE_TO_SET_DATA_EXCEPTION,
+				"No knob session is assigned for the specified multiknob file");
+		RETURN_NULL_TABLE;
+	}
+
+	// Set the value, or just end the knob session
 	int num_devices;
 	vmsstat_t status;
-	status = DPSLCUTIL_DO_MKB(mkb, &floatValue, &num_devices);
+	if (endSession) {
+		status = DPSLCUTIL_MKB_ENDSESSION(mkb, &num_devices);
+	} else {
+		status = DPSLCUTIL_DO_MKB(mkb, &floatValue, &num_devices, session);
+	}
 	FREE_MEMORY
 	if (!SUCCESS(status)) {
 		aidaThrow(env, status, UNABLE_TO_SET_DATA_EXCEPTION, "unable to set value");
@@ -724,28 +1135,22 @@ static Table setMkbValue(JNIEnv* env, const char* uri, Arguments arguments, Valu
 		RETURN_NULL_TABLE;
 	}
 
-	// Now get the new values to return
-
-	// To hold the data
-	char namesData[(num_devices * MAX_DEVICE_STRING_LEN)];
-	float secondaryValuesData[num_devices];
-
-	// Names
-	DPSLCUTIL_MKB_GETNAMES(namesData);
+	// Now create table to return, straight from the names and new values read back after the rotation
+	char* namesData;
+	float* secondaryValuesData;
+	num_devices = DPSLCUTIL_MKB_GETRESULTS(&namesData, &secondaryValuesData);
 
-	// Secondary values
-	DPSLCUTIL_MKB_GETSECNVALUES(secondaryValuesData);
+	Table table = tableCreate(env, num_devices, 2);
+	if (!(*env)->ExceptionCheck(env)) {
+		tableAddFixedWidthStringColumn(env, &table, namesData, MAX_DEVICE_STRING_LEN);
+	}
+	if (!(*env)->ExceptionCheck(env)) {
+		tableAddColumn(env, &table, AIDA_FLOAT_TYPE, secondaryValuesData, false);
+	}
 
 	// cleanup
 	DPSLCUTIL_MKB_GETCLEANUP();
 
-	// Now create table to return
-	Table table = tableCreate(env, num_devices, 2);
-	ON_EXCEPTION_RETURN_(table)
-	tableAddFixedWidthStringColumn(env, &table, namesData, MAX_DEVICE_STRING_LEN);
-	ON_EXCEPTION_RETURN_(table)
-	tableAddColumn(env, &table, AIDA_FLOAT_TYPE, secondaryValuesData, false);
-
 	return table;
 }
 
@@ -836,6 +1241,16 @@ static short getTrigStatus(JNIEnv* env, const char* uri, Arguments arguments) {
 static short getShortFaStatus(JNIEnv* env, const char* uri) {
 	int4u haStatus = faStatus(env, uri, 0, TRUE_B);
 	ON_EXCEPTION_RETURN_(0);
+	return faStateCode(haStatus);
+}
+
+/**
+ * Get the code for a feedback state
+ *
+ * @param haStatus the feedback state
+ * @return 0 = off, 1 = compute, 2 = feedback
+ */
+static short faStateCode(int4u haStatus) {
 	switch (haStatus) {
 	case FBCK_FEEDBACK_STATE:
 		return 2;
@@ -860,21 +1275,199 @@ static short getShortFaStatus(JNIEnv* env, const char* uri) {
 static char* GetStringFaStatus(JNIEnv* env, const char* uri) {
 	int4u haStatus = faStatus(env, uri, 0, TRUE_B);
 	ON_EXCEPTION_RETURN_(0);
+	return ALLOCATE_STRING(env, faStateName(haStatus), "string");
+}
+
+/**
+ * Get the name of a feedback state
+ *
+ * @param haStatus the feedback state
+ * @return sample, compute, actuate, dither, feedback or off (default)
+ */
+static char* faStateName(int4u haStatus) {
 	switch (haStatus) {
 	case FBCK_SAMPLE_STATE:
-		return ALLOCATE_STRING(env, "sample", "string");
+		return "sample";
 	case FBCK_COMPUTE_STATE:
-		return ALLOCATE_STRING(env, "compute", "string");
+		return "compute";
 	case FBCK_ACTUATE_STATE:
-		return ALLOCATE_STRING(env, "actuate", "string");
+		return "actuate";
 	case FBCK_DITHER_STATE:
-		return ALLOCATE_STRING(env, "dither", "string");
+		return "dither";
 	case FBCK_FEEDBACK_STATE:
-		return ALLOCATE_STRING(env, "feedback", "string");
+		return "feedback";
 	case FBCK_OFF_STATE:
 	default:
-		return ALLOCATE_STRING(env, "off", "string");
+		return "off";
+	}
+}
+
+/**
+ * Get a table of the statuses of many trigger devices on a beam code.
+ * The helper reads the devices one at a time, so this saves the client round trips but not the backend ones.
+ * The `DEVICES` argument lists the trigger devices, e.g. `["TRIG:LI31:109", "TRIG:LI31:110"]`.
+ *
+ * If the status of none of the devices can be read an exception is raised.
+ * Otherwise the following fields are returned:
+ * 		`name`		STRING		device name
+ * 		`opstat`	BOOLEAN		operation status (true = success, false = failure)
+ * 		`status`	SHORT		0 => deactivated, 1 => activated, 0 if the status could not be read
+ *
+ * @param env to report errors
+ * @param arguments the arguments
+ * @return the table
+ */
+static Table getTrigStatuses(JNIEnv* env, Arguments arguments) {
+	TRACK_ALLOCATED_MEMORY
+
+	// Get the arguments
+	int beam;
+	char** devices = NULL;
+	unsigned int nDevices = 0;
+	if (ascanf(env, &arguments, "%d %sa",
+			"beam", &beam,
+			"devices", &devices, &nDevices
+	)) {
+		RETURN_NULL_TABLE
+	}
+	TRACK_MEMORY(devices)
+
+	if (!nDevices) {
+		FREE_MEMORY
+		aidaThrowNonOsException(env, MISSING_REQUIRED_ARGUMENT_EXCEPTION, "No DEVICES were given");
+		RETURN_NULL_TABLE
+	}
+
+	// One block for the request statuses, statuses, and opstats, widest first so that each array is aligned
+	vmsstat_t* statuses = ALLOCATE_MEMORY(env, nDevices * (sizeof(vmsstat_t) + sizeof(short) + sizeof(bool)),
+			"trigger statuses");
+	if (!statuses) {
+		FREE_MEMORY
+		RETURN_NULL_TABLE
+	}
+	TRACK_MEMORY(statuses)
+	short* trigStatuses = (short*)(statuses + nDevices);
+	bool* opstats = (bool*)(trigStatuses + nDevices);
+
+	// Read all the statuses
+	if (!DPSLCUTIL_TRIG_GETSTATUSES((int)nDevices, devices, beam, trigStatuses, statuses)) {
+		FREE_MEMORY
+		aidaThrowNonOsException(env, UNABLE_TO_GET_DATA_EXCEPTION,
+				"Unable to get the status of any of the trigger devices");
+		RETURN_NULL_TABLE
+	}
+
+	for (int i = 0; i < nDevices; i++) {
+		opstats[i] = SUCCESS(statuses[i]);
 	}
+
+	Table table = tableCreate(env, (int)nDevices, 3);
+	if (!(*env)->ExceptionCheck(env)) {
+		tableAddStringColumn(env, &table, devices);
+	}
+	if (!(*env)->ExceptionCheck(env)) {
+		tableAddColumn(env, &table, AIDA_BOOLEAN_TYPE, opstats, true);
+	}
+	if (!(*env)->ExceptionCheck(env)) {
+		tableAddColumn(env, &table, AIDA_SHORT_TYPE, trigStatuses, true);
+	}
+
+	FREE_MEMORY
+	return table;
+}
+
+/**
+ * Get a table of the states of many SCP transverse feedback loops.
+ * The `DEVICES` argument lists the loops, e.g. `["FBCK:LI18:28", "FBCK:LI11:26"]`.
+ *
+ * If the state of none of the loops can be read an exception is raised.
+ * Otherwise the following fields are returned:
+ * 		`name`		STRING		loop name
+ * 		`opstat`	BOOLEAN		operation status (true = success, false = failure)
+ * 		`status`	SHORT		0 => off, 1 => compute, 2 => feedback, -1 if the state could not be read
+ * 		`state`		STRING		sample, compute, actuate, dither, feedback or off, unknown if the state could not be read
+ * 		`hsta`		INTEGER		the HSTA bitmask of the loop, 0 if it could not be read
+ *
+ * @param env to report errors
+ * @param arguments the arguments
+ * @return the table
+ */
+static Table getFaStatuses(JNIEnv* env, Arguments arguments) {
+	TRACK_ALLOCATED_MEMORY
+	DESCR_DECLARE;
+
+	// Get the arguments
+	char** devices = NULL;
+	unsigned int nDevices = 0;
+	if (ascanf(env, &arguments, "%sa", "devices", &devices, &nDevices)) {
+		RETURN_NULL_TABLE
+	}
+	TRACK_MEMORY(devices)
+
+	if (!nDevices) {
+		FREE_MEMORY
+		aidaThrowNonOsException(env, MISSING_REQUIRED_ARGUMENT_EXCEPTION, "No DEVICES were given");
+		RETURN_NULL_TABLE
+	}
+
+	// One block for the state name pointers, HSTAs, codes, and opstats
+	char** stateNames = ALLOCATE_MEMORY(env,
+			nDevices * (sizeof(char*) + sizeof(int4u) + sizeof(short) + sizeof(bool)), "feedback statuses");
+	if (!stateNames) {
+		FREE_MEMORY
+		RETURN_NULL_TABLE
+	}
+	TRACK_MEMORY(stateNames)
+	int4u* hstas = (int4u*)(stateNames + nDevices);
+	short* codes = (short*)(hstas + nDevices);
+	bool* opstats = (bool*)(codes + nDevices);
+
+	// Read the state of each loop, a loop that can't be read doesn't stop the others
+	int nRead = 0;
+	vmsstat_t firstStatus = 0;
+	for (int i = 0; i < nDevices; i++) {
+		fbckhsta_tu lastHsta;
+		lastHsta.lword = 0;
+		vmsstat_t status = FA_CHANGE_HSTA(DESCRA1(devices[i]), 0, TRUE_B, &lastHsta.bit_s);
+		opstats[i] = SUCCESS(status);
+		if (opstats[i]) {
+			nRead++;
+		} else {
+			if (!firstStatus) {
+				firstStatus = status;
+			}
+			lastHsta.lword = 0;
+		}
+		hstas[i] = lastHsta.lword;
+		codes[i] = opstats[i] ? faStateCode(hstas[i]) : (short)-1;
+		stateNames[i] = opstats[i] ? faStateName(hstas[i]) : "unknown";
+	}
+
+	if (!nRead) {
+		FREE_MEMORY
+		aidaThrow(env, firstStatus, UNABLE_TO_GET_DATA_EXCEPTION, "unable to get feedback state");
+		RETURN_NULL_TABLE
+	}
+
+	Table table = tableCreate(env, (int)nDevices, 5);
+	if (!(*env)->ExceptionCheck(env)) {
+		tableAddStringColumn(env, &table, devices);
+	}
+	if (!(*env)->ExceptionCheck(env)) {
+		tableAddColumn(env, &table, AIDA_BOOLEAN_TYPE, opstats, true);
+	}
+	if (!(*env)->ExceptionCheck(env)) {
+		tableAddColumn(env, &table, AIDA_SHORT_TYPE, codes, true);
+	}
+	if (!(*env)->ExceptionCheck(env)) {
+		tableAddStringColumn(env, &table, stateNames);
+	}
+	if (!(*env)->ExceptionCheck(env)) {
+		tableAddColumn(env, &table, AIDA_INTEGER_TYPE, hstas, true);
+	}
+
+	FREE_MEMORY
+	return table;
 }
 
 /**
@@ -948,4 +1541,3 @@ static void setFeedback(JNIEnv* env, const char* uri, Arguments arguments, Value
 	}
 	faStatus(env, uri, newHSTA, FALSE_B);
 }
-
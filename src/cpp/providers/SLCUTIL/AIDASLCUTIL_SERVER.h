@@ -15,12 +15,16 @@ extern "C" {
 #define MAX_DEVICE_STRING_LEN 20
 
 extern int DPSLCUTIL_MKB_ACCESSENABLED(void);
-extern vmsstat_t DPSLCUTIL_DO_MKB(char*, float*, int*);
+extern vmsstat_t DPSLCUTIL_DO_MKB(char*, float*, int*, int);
+extern int DPSLCUTIL_MKB_INSESSION(char*);
+extern vmsstat_t DPSLCUTIL_MKB_ENDSESSION(char*, int*);
 extern int DPSLCUTIL_MKB_GETABSFLAG(void);
 extern void DPSLCUTIL_MKB_GETNAMES(char*);
 extern void DPSLCUTIL_MKB_GETSECNVALUES(float*);
+extern int DPSLCUTIL_MKB_GETRESULTS(char**, float**);
 extern void DPSLCUTIL_MKB_GETCLEANUP(void);
 extern int DPSLCUTIL_TRIG_GETSTATUS(char*, int, short*);
+extern int DPSLCUTIL_TRIG_GETSTATUSES(int, char**, int, short*, vmsstat_t*);
 extern int DPSLCUTIL_TRIG_ACCESSENABLED(void);
 extern int DPSLCUTIL_TRIG_SETDEACTORREACT(char*, int, int);
 extern int DPSLCUTIL_BGRP_ACCESSENABLED(void);
@@ -52,6 +56,73 @@ extern unsigned long int BPMD_SELECT_UTIL(short int  *,long int  *,long int  *,
 #define BPMD_MAX 9999
 #define NUMOFFSET 3
 
+#define MAX_CORRPLOT_JOBS 4                   // Correlation plot jobs that can be kept at the same time
+#define CORRPLOT_JOB_RETENTION_DEFAULT 300.0  // Seconds a job is kept after it was last requested, by default
+#define CORRPLOT_NAME_LEN 64                  // Longest button file, step variable, or column name kept for a job
+#define CORRPLOT_RING_ROWS 256                // Rows kept for a streamed job, rounded to whole chunks
+#define CORRPLOT_CHUNK_DEFAULT 2              // Primary steps run each time a job is polled, unless CHUNK is given
+
+/**
+ * The state of a correlation plot job
+ */
+typedef enum
+{
+	CORRPLOT_JOB_RUNNING = 1,
+	CORRPLOT_JOB_COMPLETE,
+	CORRPLOT_JOB_CANCELLED,
+	CORRPLOT_JOB_FAILED
+} CorrPlotJobState;
+
+/**
+ * The parameters of a correlation plot scan
+ */
+typedef struct
+{
+	char buttonFileName[CORRPLOT_NAME_LEN];
+	char primaryStepVariable[CORRPLOT_NAME_LEN];
+	char secondaryStepVariable[CORRPLOT_NAME_LEN];
+	bool secondaryStepVariableProvided;
+	float primaryLow, primaryHigh, primarySettleTime, primaryExtraSettleTime;
+	float secondaryLow, secondaryHigh, secondarySettleTime, secondaryExtraSettleTime;
+	int primarySteps, secondarySteps;
+	short bpmd;
+	long nrpos, dtizavg;
+	char magnetFunction[5];                   // Empty if not given
+} CorrPlotScan;
+
+/**
+ * A step or sample variable of a correlation plot, and the columns it is returned in
+ */
+typedef struct
+{
+	long varNum;                              // 0 for the primary, -1 for the secondary step variable
+	bool noErrors;                            // TIME, ATIME, and SAMP variables have no error or ok columns
+	char field[CORRPLOT_NAME_LEN];
+	char label[CORRPLOT_NAME_LEN];
+} CorrPlotVariable;
+
+/**
+ * A correlation plot job.  The scan is run a chunk of primary steps at a time, as it is polled,
+ * and the rows acquired so far are kept until the job expires.  A streamed job only keeps its latest rows,
+ * in a ring of whole chunks, so row r is always at r % capacity
+ */
+typedef struct
+{
+	int id;                                   // 0 if the job slot is unused
+	CorrPlotJobState state;
+	CorrPlotScan scan;
+	int chunk;                                // Primary steps run each time the job is polled
+	bool stream;                              // True if only the latest rows are kept
+	float retention;                          // Seconds the job is kept after it was last requested
+	double lastRequested;
+	int stepsDone;                            // Primary steps run so far
+	int rows, capacity;                       // Rows acquired so far, and rows there is space for
+	int nVariables;
+	CorrPlotVariable* variables;              // One block for the variables then their values, errors, and oks
+	float* values, * errors;
+	long* oks;
+} CorrPlotJob;
+
 
 #ifdef __cplusplus
 }
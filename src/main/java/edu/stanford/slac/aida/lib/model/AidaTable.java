@@ -7,6 +7,8 @@ package edu.stanford.slac.aida.lib.model;
 import lombok.Getter;
 import lombok.ToString;
 
+import java.nio.ByteBuffer;
+import java.nio.ByteOrder;
 import java.util.ArrayList;
 import java.util.List;
 
@@ -17,11 +19,37 @@ import java.util.List;
  * It is the class that is returned from the Native Providers for requests that return a TABLE.
  * <p>
  * It contains a single property AidaTable::getData() that stores a List of column Lists.
+ * <p>
+ * Alternatively, the Native Provider may write the whole table, as a columnar payload, into a direct
+ * ByteBuffer obtained from AidaTable::columnBuffer(int).  Buffers up to a few MB are pooled per thread and reused
+ * across requests, and are decoded by {@link edu.stanford.slac.aida.lib.util.AidaPVHelper}.
  *
  * @note Note that it uses the `lombok.ToString` annotation to provide the toString() method.
  */
 @ToString
 public class AidaTable {
+    /**
+     * The smallest column buffer that will be allocated
+     */
+    private static final int MIN_COLUMN_BUFFER_SIZE = 64 * 1024;
+
+    /**
+     * The largest column buffer that will be allocated.  Larger tables are returned using AidaTable::add(int, Object)
+     */
+    private static final int MAX_COLUMN_BUFFER_SIZE = 64 * 1024 * 1024;
+
+    /**
+     * The largest column buffer that will be kept in a thread's pool.  Larger buffers are allocated for the one
+     * table that needs them and are released with it, so that one oversized table doesn't pin its buffer for the
+     * life of the thread
+     */
+    private static final int MAX_POOLED_COLUMN_BUFFER_SIZE = 4 * 1024 * 1024;
+
+    /**
+     * Pool of direct column buffers, one per thread, reused for each table returned on that thread
+     */
+    private static final ThreadLocal<ByteBuffer> columnBuffers = new ThreadLocal<ByteBuffer>();
+
     /**
      * The property that is used to return the table data.  A simple List of column Lists.
      * The inner, column, Lists are simply {@link List<Object>} to be able to represent any type of data
@@ -43,6 +71,62 @@ public class AidaTable {
     @Getter
     private final List<String> fields = new ArrayList<String>();
 
+    /**
+     * The columnar payload written by the provider, or null if the table was built with AidaTable::add(int, Object).
+     * It holds the buffer's position at zero and its limit at the end of the payload.  It is only set, by
+     * AidaTable::setColumnData(ByteBuffer), once the provider has written the whole payload
+     */
+    @Getter
+    private ByteBuffer columnData;
+
+    /**
+     * Get a direct ByteBuffer, in native byte order, for the provider to write this table's columnar payload into.
+     * The buffer is taken from this thread's pool, and is only reallocated when a larger one is needed.  A buffer
+     * larger than MAX_POOLED_COLUMN_BUFFER_SIZE is not pooled, it is only used for this table.
+     * <p>
+     * The buffer is not this table's payload until the provider has written it and called
+     * AidaTable::setColumnData(ByteBuffer).  The payload must be decoded before the next table is returned
+     * on the same thread.
+     *
+     * @param size the size, in bytes, of the payload to be written
+     * @return the buffer, with its limit set to size, or null if the payload is too large, in which case the
+     * provider must fall back to AidaTable::add(int, Object)
+     * @warning This is called by the Channel Provider code in C so be careful when refactoring the signature or name.
+     */
+    public ByteBuffer columnBuffer(int size) {
+        if (size < 0 || size > MAX_COLUMN_BUFFER_SIZE) {
+            return null;
+        }
+
+        ByteBuffer buffer = columnBuffers.get();
+        if (buffer == null || buffer.capacity() < size) {
+            int capacity = MIN_COLUMN_BUFFER_SIZE;
+            while (capacity < size) {
+                capacity *= 2;
+            }
+            buffer = ByteBuffer.allocateDirect(capacity).order(ByteOrder.nativeOrder());
+            if (capacity <= MAX_POOLED_COLUMN_BUFFER_SIZE) {
+                columnBuffers.set(buffer);
+            }
+        }
+
+        buffer.clear();
+        buffer.limit(size);
+        this.columnData = null;
+        return buffer;
+    }
+
+    /**
+     * Publish the columnar payload that the provider has finished writing into the buffer from
+     * AidaTable::columnBuffer(int).  Until this is called the table is decoded from AidaTable::getData()
+     *
+     * @param buffer the buffer holding the whole payload
+     * @warning This is called by the Channel Provider code in C so be careful when refactoring the signature or name.
+     */
+    public void setColumnData(ByteBuffer buffer) {
+        this.columnData = buffer;
+    }
+
     /**
      * Add an element to the specified column in this AidaTable::getData().
      * <p>
@@ -58,22 +142,9 @@ public class AidaTable {
     public boolean add(int columnId, Object object) {
         // Only allow this to be run by one thread at a time
         synchronized (this.data) {
-            // Get the current number of columns in  AidaTable::getData()
-            int currentColumnCount = this.data.size();
-
-            // If we don't have enough columns then we need to add new ones from the end of the current list
-            // up to the new columnId given
-            if (currentColumnCount <= columnId) {
-                // Loop from end of current list to new size = columnId
-                for (int collectionCounter = currentColumnCount - 1; collectionCounter < columnId; collectionCounter++) {
-                    // Add new columns
-                    this.data.add(new ArrayList<Object>());
-                }
-            }
-
-            // Now get the column identified by columnId as it will now definitely exist
-            List<Object> column = this.data.get(columnId);
-            // If by some crazy alignment of the stars it does not then return failure
+            // Get the column identified by columnId, creating it if necessary
+            List<Object> column = getColumn(columnId);
+            // If by some crazy alignment of the stars it does not exist then return failure
             if (column == null) {
                 return false;
             }
@@ -89,6 +160,40 @@ public class AidaTable {
         }
     }
 
+    /**
+     * Add all the given elements to the specified column in this AidaTable::getData().
+     * <p>
+     * This is used to add a whole column in one call, e.g. for String columns
+     * that are converted to a String[] in one pass.
+     *
+     * @param columnId the number representing the number of the column to add to
+     * @param objects  the objects to add to that column
+     * @return true if added correctly
+     * @warning This is called by the Channel Provider code in C so be careful when refactoring the signature or name.
+     */
+    public boolean addAll(int columnId, Object[] objects) {
+        if (objects == null) {
+            return add(columnId, null);
+        }
+
+        // Only allow this to be run by one thread at a time
+        synchronized (this.data) {
+            List<Object> column = getColumn(columnId);
+            if (column == null) {
+                return false;
+            }
+
+            // Make room for the whole column up front, and add each element in order
+            if (column instanceof ArrayList) {
+                ((ArrayList<Object>) column).ensureCapacity(column.size() + objects.length);
+            }
+            for (Object object : objects) {
+                column.add(object == null ? "<null>" : object);
+            }
+            return true;
+        }
+    }
+
     /**
      * Add a field to this table to override the configured fields.  It is
      * the responsibility of the caller to add fields in column order
@@ -113,6 +218,31 @@ public class AidaTable {
         return labels.add(label);
     }
 
+    /**
+     * Get the column identified by columnId in AidaTable::getData(), adding
+     * any missing columns up to and including it.  Must be called while holding the data lock.
+     *
+     * @param columnId the number representing the number of the column to get
+     * @return the column
+     */
+    private List<Object> getColumn(int columnId) {
+        // Get the current number of columns in  AidaTable::getData()
+        int currentColumnCount = this.data.size();
+
+        // If we don't have enough columns then we need to add new ones from the end of the current list
+        // up to the new columnId given
+        if (currentColumnCount <= columnId) {
+            // Loop from end of current list to new size = columnId
+            for (int collectionCounter = currentColumnCount - 1; collectionCounter < columnId; collectionCounter++) {
+                // Add new columns
+                this.data.add(new ArrayList<Object>());
+            }
+        }
+
+        // Now get the column identified by columnId as it will now definitely exist
+        return this.data.get(columnId);
+    }
+
     /**
      * Get the list underpinning this AidaTable object
      *
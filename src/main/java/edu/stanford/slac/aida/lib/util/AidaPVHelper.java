@@ -13,10 +13,13 @@ import org.epics.pvdata.factory.FieldFactory;
 import org.epics.pvdata.pv.*;
 import org.epics.util.array.*;
 
+import java.nio.ByteBuffer;
+import java.nio.charset.Charset;
 import java.util.ArrayList;
 import java.util.Iterator;
 import java.util.List;
 
+import static edu.stanford.slac.aida.lib.model.AidaType.BOOLEAN_ARRAY;
 import static edu.stanford.slac.aida.lib.model.AidaType.STRING_ARRAY;
 import static edu.stanford.slac.aida.lib.model.AidaType.aidaTypeOf;
 import static org.epics.pvdata.pv.ScalarType.pvString;
@@ -68,6 +71,11 @@ public class AidaPVHelper {
      */
     private static final String NTTABLE_ID = "epics:nt/NTTable:1.0";
 
+    /**
+     * The character set of the strings in a columnar table payload written by a Native Provider
+     */
+    private static final Charset COLUMN_DATA_CHARSET = Charset.forName("UTF-8");
+
     /**
      * The Normative Type specification defines the name of the field containing the value part
      * of its main types (Scalar, ScalarArray, and Table) as "value".
@@ -217,8 +225,21 @@ public class AidaPVHelper {
      * @param values    the values to set in the field.
      * @param aidaType  the {@link AidaType} of the values to set.
      */
-    @SuppressWarnings("unchecked")
     private static void setValues(@NonNull PVStructure structure, @NonNull String fieldName, @NonNull List<?> values, @NonNull AidaType aidaType) {
+        setValues(structure, fieldName, toPrimitiveArray(values, aidaType), values.size(), aidaType);
+    }
+
+    /**
+     * Set the value of any array field in an already created PVStructure to the given
+     * primitive array of values.  See AidaPVHelper::setValues(PVStructure, String, List, AidaType)
+     *
+     * @param structure   the given structure.
+     * @param fieldName   the name of the array field.
+     * @param values      the values to set in the field, a primitive array, or String[], matching the aidaType.
+     * @param valuesCount the number of values.
+     * @param aidaType    the {@link AidaType} of the values to set.
+     */
+    private static void setValues(@NonNull PVStructure structure, @NonNull String fieldName, @NonNull Object values, int valuesCount, @NonNull AidaType aidaType) {
         // If the `fieldName` parameter is specified as a path then find the target structure where the values
         // have to eventually be set
         String[] fieldParts = fieldName.split("\\.");
@@ -230,9 +251,6 @@ public class AidaPVHelper {
 
         // Now we have the target `structure` that we want to set `fieldName` to `values`
 
-        // Find out how many values there are
-        int valuesCount = values.size();
-
         // Locate the array that was defined in the first stage of
         // this PVStructure creation
         // and set the capacity to the number of values we need to store
@@ -240,39 +258,37 @@ public class AidaPVHelper {
         scalarArray.setCapacity(valuesCount);
 
         // Depending on the type of the values to add, call the correct method to add the values
-        // In each case we can't add boxed values, so we convert to a primitive array first
-        // then add that primitive array to the structure's field.
         switch (aidaType) {
             case BOOLEAN_ARRAY: {
-                ((PVBooleanArray) scalarArray).put(0, valuesCount, toPrimitiveBooleanArray(((List<Boolean>) values)), 0);
+                ((PVBooleanArray) scalarArray).put(0, valuesCount, (boolean[]) values, 0);
                 break;
             }
             case BYTE_ARRAY: {
-                ((PVByteArray) scalarArray).put(0, valuesCount, toPrimitiveByteArray((List<Byte>) values), 0);
+                ((PVByteArray) scalarArray).put(0, valuesCount, (byte[]) values, 0);
                 break;
             }
             case INTEGER_ARRAY: {
-                ((PVIntArray) scalarArray).put(0, valuesCount, toPrimitiveIntArray((List<Integer>) values), 0);
+                ((PVIntArray) scalarArray).put(0, valuesCount, (int[]) values, 0);
                 break;
             }
             case SHORT_ARRAY: {
-                ((PVShortArray) scalarArray).put(0, valuesCount, toPrimitiveShortArray((List<Short>) values), 0);
+                ((PVShortArray) scalarArray).put(0, valuesCount, (short[]) values, 0);
                 break;
             }
             case LONG_ARRAY: {
-                ((PVLongArray) scalarArray).put(0, valuesCount, toPrimitiveLongArray((List<Long>) values), 0);
+                ((PVLongArray) scalarArray).put(0, valuesCount, (long[]) values, 0);
                 break;
             }
             case FLOAT_ARRAY: {
-                ((PVFloatArray) scalarArray).put(0, valuesCount, toPrimitiveFloatArray((List<Float>) values), 0);
+                ((PVFloatArray) scalarArray).put(0, valuesCount, (float[]) values, 0);
                 break;
             }
             case DOUBLE_ARRAY: {
-                ((PVDoubleArray) scalarArray).put(0, valuesCount, toPrimitiveDoubleArray((List<Double>) values), 0);
+                ((PVDoubleArray) scalarArray).put(0, valuesCount, (double[]) values, 0);
                 break;
             }
             case STRING_ARRAY: {
-                ((PVStringArray) scalarArray).put(0, valuesCount, toStringArray((List<String>) values), 0);
+                ((PVStringArray) scalarArray).put(0, valuesCount, (String[]) values, 0);
                 break;
             }
         }
@@ -281,6 +297,38 @@ public class AidaPVHelper {
         scalarArray.setImmutable();
     }
 
+    /**
+     * Convert a list of boxed values to the primitive array, or String[], for the given {@link AidaType}.
+     * We can't add boxed values to a PVScalarArray, so we convert to a primitive array first
+     *
+     * @param values   the list of values
+     * @param aidaType the {@link AidaType} of the values
+     * @return the primitive array
+     */
+    @SuppressWarnings("unchecked")
+    private static Object toPrimitiveArray(@NonNull List<?> values, @NonNull AidaType aidaType) {
+        switch (aidaType) {
+            case BOOLEAN_ARRAY:
+                return toPrimitiveBooleanArray((List<Boolean>) values);
+            case BYTE_ARRAY:
+                return toPrimitiveByteArray((List<Byte>) values);
+            case INTEGER_ARRAY:
+                return toPrimitiveIntArray((List<Integer>) values);
+            case SHORT_ARRAY:
+                return toPrimitiveShortArray((List<Short>) values);
+            case LONG_ARRAY:
+                return toPrimitiveLongArray((List<Long>) values);
+            case FLOAT_ARRAY:
+                return toPrimitiveFloatArray((List<Float>) values);
+            case DOUBLE_ARRAY:
+                return toPrimitiveDoubleArray((List<Double>) values);
+            case STRING_ARRAY:
+                return toStringArray((List<String>) values);
+            default:
+                throw new AidaInternalException("Unsupported type for array values: " + aidaType);
+        }
+    }
+
     /**
      * Convert an arbitrary value to a PVStructure containing an `NTScalar`
      * <p>
@@ -379,38 +427,58 @@ public class AidaPVHelper {
      * - Boolean, Byte, Short,
      * - Integer, Long, Float,
      * - Double or String
+     * <p>
+     * If the provider wrote the table as a columnar payload into AidaTable::columnBuffer(int) then
+     * the columns are decoded from that instead, straight into primitive arrays.
      *
      * @param table             the table
      * @param aidaChannelConfig the configuration
      * @return the returned PVStructure containing the NT_TABLE
      */
     public static PVStructure asNtTable(AidaTable table, AidaChannelOperationConfig aidaChannelConfig) {
-        List<List<Object>> values = table.asList();
+        // Each column as a primitive array, or String[], and its type
+        List<Object> columnValues = new ArrayList<Object>();
+        List<AidaType> aidaTypes = new ArrayList<AidaType>();
+        int columnSize;
 
-        // If there is nothing to add or that the list is empty or if the columns are empty return an empty
-        //  PVStructure
-        if (values == null || values.isEmpty() || values.get(0).isEmpty()) {
-            return NT_TABLE_EMPTY_STRUCTURE;
-        }
+        ByteBuffer columnData = table.getColumnData();
+        if (columnData != null) {
+            // The provider wrote the table as a columnar payload, so decode it straight into primitive arrays
+            columnSize = decodeColumnData(columnData, aidaTypes, columnValues);
+        } else {
+            List<List<Object>> values = table.asList();
 
-        // If the lists are not homogeneously sized then raise an exception
-        int columnSize = values.get(0).size();
-        for (List<Object> column : values) {
-            if (column.size() != columnSize) {
-                throw new AidaInternalException("Columns in NTTable not homogeneously sized. Normal size: " + columnSize + ", One column size: " + column.size());
+            // If there is nothing to add or that the list is empty or if the columns are empty return an empty
+            //  PVStructure
+            if (values == null || values.isEmpty() || values.get(0).isEmpty()) {
+                return NT_TABLE_EMPTY_STRUCTURE;
+            }
+
+            // If the lists are not homogeneously sized then raise an exception
+            columnSize = values.get(0).size();
+            for (List<Object> column : values) {
+                if (column.size() != columnSize) {
+                    throw new AidaInternalException("Columns in NTTable not homogeneously sized. Normal size: " + columnSize + ", One column size: " + column.size());
+                }
+                AidaType aidaType = aidaTypeOf(column);
+                aidaTypes.add(aidaType);
+                columnValues.add(toPrimitiveArray(column, aidaType));
             }
         }
 
+        if (columnValues.isEmpty() || columnSize == 0) {
+            return NT_TABLE_EMPTY_STRUCTURE;
+        }
+
         // The field names, labels and types for an NTTable come from the Channel Configuration specified in the
         // Channel Configuration File loaded when the service initialises.
         // We need to retrieve these configured values from the given configuration associated with the
         // request we're processing
         List<String> fieldNames = table.getFields();
         List<String> labels = table.getLabels();
-        List<AidaType> aidaTypes = new ArrayList<AidaType>();
         // We need to create a set of fields that we will fill with these values
         List<Field> pvFields = new ArrayList<Field>();
-        setFieldsWithNamesLabelsAndTypesFromConfig(pvFields, aidaChannelConfig, values, fieldNames, labels, aidaTypes);
+        setFieldsWithNamesLabelsAndTypesFromConfig(pvFields, aidaChannelConfig, aidaTypes, fieldNames, labels);
 
         /// FIRST STAGE PVStructure creation: Structure
 
@@ -441,39 +509,154 @@ public class AidaPVHelper {
         // Set array values
         for (int i = 0; i < fieldNames.size(); i++) {
             String fieldName = NT_FIELD_NAME + "." + fieldNames.get(i);
-            List<?> columnValues = values.get(i);
-            AidaType aidaType = aidaTypes.get(i);
-
-            setValues(retVal, fieldName, columnValues, aidaType);
+            setValues(retVal, fieldName, columnValues.get(i), columnSize, aidaTypes.get(i));
         }
 
         return retVal;
     }
 
     /**
-     * Get the fields, field names, labels and types from the supplied values and config
+     * Decode the columnar payload that a Native Provider has written into the buffer returned by AidaTable::columnBuffer(int).
+     * <p>
+     * The payload is in native byte order:
+     * - int column count, int row count
+     * - then, for each column, starting on an 8 byte boundary
+     *   - int type: 0 = BOOLEAN, 1 = BYTE, 2 = SHORT, 3 = INTEGER, 4 = LONG, 5 = FLOAT, 6 = DOUBLE, 7 = STRING
+     *   - int number of distinct strings for STRING columns, otherwise 0
+     *   - the row count values, booleans as one byte each, or for STRING columns the distinct strings,
+     *     each an int length followed by its UTF-8 bytes, then, on a 4 byte boundary, an int index into the
+     *     distinct strings for each row
+     *
+     * @param buffer       the payload
+     * @param aidaTypes    the list to populate with the {@link AidaType} of each column - provide an empty list
+     * @param columnValues the list to populate with the primitive array, or String[], of each column - provide an empty list
+     * @return the number of rows
+     */
+    private static int decodeColumnData(ByteBuffer buffer, List<AidaType> aidaTypes, List<Object> columnValues) {
+        buffer.position(0);
+        int columnCount = buffer.getInt();
+        int rowCount = buffer.getInt();
+
+        for (int column = 0; column < columnCount; column++) {
+            buffer.position(alignedPosition(buffer.position(), 8));
+            int typeCode = buffer.getInt();
+            int distinctCount = buffer.getInt();
+            if (typeCode < 0 || typeCode > STRING_ARRAY.ordinal() - BOOLEAN_ARRAY.ordinal()) {
+                throw new AidaInternalException("Unsupported type found in table column data: " + typeCode);
+            }
+            AidaType aidaType = AidaType.values()[BOOLEAN_ARRAY.ordinal() + typeCode];
+
+            Object values;
+            switch (aidaType) {
+                case BOOLEAN_ARRAY: {
+                    boolean[] booleans = new boolean[rowCount];
+                    for (int row = 0; row < rowCount; row++) {
+                        booleans[row] = buffer.get() != 0;
+                    }
+                    values = booleans;
+                    break;
+                }
+                case BYTE_ARRAY: {
+                    byte[] bytes = new byte[rowCount];
+                    buffer.get(bytes);
+                    values = bytes;
+                    break;
+                }
+                case SHORT_ARRAY: {
+                    short[] shorts = new short[rowCount];
+                    buffer.asShortBuffer().get(shorts);
+                    buffer.position(buffer.position() + rowCount * 2);
+                    values = shorts;
+                    break;
+                }
+                case INTEGER_ARRAY: {
+                    int[] ints = new int[rowCount];
+                    buffer.asIntBuffer().get(ints);
+                    buffer.position(buffer.position() + rowCount * 4);
+                    values = ints;
+                    break;
+                }
+                case LONG_ARRAY: {
+                    long[] longs = new long[rowCount];
+                    buffer.asLongBuffer().get(longs);
+                    buffer.position(buffer.position() + rowCount * 8);
+                    values = longs;
+                    break;
+                }
+                case FLOAT_ARRAY: {
+                    float[] floats = new float[rowCount];
+                    buffer.asFloatBuffer().get(floats);
+                    buffer.position(buffer.position() + rowCount * 4);
+                    values = floats;
+                    break;
+                }
+                case DOUBLE_ARRAY: {
+                    double[] doubles = new double[rowCount];
+                    buffer.asDoubleBuffer().get(doubles);
+                    buffer.position(buffer.position() + rowCount * 8);
+                    values = doubles;
+                    break;
+                }
+                default: {
+                    // Each distinct string is decoded once and shared by all the rows that refer to it
+                    String[] distinctStrings = new String[distinctCount];
+                    for (int i = 0; i < distinctCount; i++) {
+                        int length = buffer.getInt();
+                        ByteBuffer stringBytes = buffer.duplicate();
+                        stringBytes.limit(buffer.position() + length);
+                        distinctStrings[i] = COLUMN_DATA_CHARSET.decode(stringBytes).toString();
+                        buffer.position(buffer.position() + length);
+                    }
+                    buffer.position(alignedPosition(buffer.position(), 4));
+
+                    String[] strings = new String[rowCount];
+                    for (int row = 0; row < rowCount; row++) {
+                        strings[row] = distinctStrings[buffer.getInt()];
+                    }
+                    values = strings;
+                    break;
+                }
+            }
+
+            aidaTypes.add(aidaType);
+            columnValues.add(values);
+        }
+
+        return rowCount;
+    }
+
+    /**
+     * Round the given buffer position up to the given alignment
+     *
+     * @param position  the position
+     * @param alignment the alignment, a power of two
+     * @return the aligned position
+     */
+    private static int alignedPosition(int position, int alignment) {
+        return (position + alignment - 1) & ~(alignment - 1);
+    }
+
+    /**
+     * Get the fields, field names and labels from the supplied column types and config
      *
      * @param fieldsToPopulate      the fields to populate - provide an empty list
      * @param channelConfig         the config
-     * @param values                the supplied values
+     * @param aidaTypes             the type of each column
      * @param fieldNamesToPopulate  the field names to populate - provide an empty list if you want to generate field names
      * @param fieldLabelsToPopulate the labels to populate - provide an empty list if you want to generate labels
-     * @param fieldTypesToPopulate  the types to populate - provide an empty list
      */
     private static void setFieldsWithNamesLabelsAndTypesFromConfig(
-            List<Field> fieldsToPopulate, AidaChannelOperationConfig channelConfig, List<List<Object>> values,
-            List<String> fieldNamesToPopulate, List<String> fieldLabelsToPopulate, List<AidaType> fieldTypesToPopulate) {
+            List<Field> fieldsToPopulate, AidaChannelOperationConfig channelConfig, List<AidaType> aidaTypes,
+            List<String> fieldNamesToPopulate, List<String> fieldLabelsToPopulate) {
 
         boolean addFieldsFromConfig = fieldNamesToPopulate.isEmpty();
         boolean addLabelsFromConfig = fieldLabelsToPopulate.isEmpty();
 
-        // Loop over values and fields simultaneously
+        // Loop over column types and fields simultaneously
         Iterator<AidaField> fieldIterator = channelConfig.getFields().listIterator();
-        for (List<?> column : values) {
-            AidaType aidaType = aidaTypeOf(column);
+        for (AidaType aidaType : aidaTypes) {
             ScalarType scalarType = scalarTypeOf(aidaType);
             fieldsToPopulate.add(FieldFactory.getFieldCreate().createScalarArray(scalarType));
-            fieldTypesToPopulate.add(aidaType);
 
             // If the provider has not overridden the fields or labels then load from config
             if (addFieldsFromConfig || addLabelsFromConfig) {